@@ -1,16 +1,31 @@
+#include "clang/AST/RecordLayout.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Refactoring.h"
 #include "clang/Tooling/Tooling.h"
 
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/VirtualFileSystem.h"
 
 #include "llvm/Support/raw_ostream.h"
 
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include <thread>
 #include <unordered_map>
 
 using namespace llvm;
@@ -20,6 +35,37 @@ static llvm::cl::OptionCategory s_MinimetaCategory{"minimeta options"};
 static cl::extrahelp s_CommonHelp{CommonOptionsParser::HelpMessage};
 static cl::extrahelp s_MoreHelp{"\nFor more info: https://github.com/pvnetto/minimeta\n"};
 
+enum class LayoutReportFormat { None, Text, Json };
+
+static cl::opt<LayoutReportFormat> s_LayoutReport{
+    "layout-report",
+    cl::desc("Report padding holes, cache line straddling and a tighter field order for every reflected type"),
+    cl::values(clEnumValN(LayoutReportFormat::Text, "text", "Human-readable report"),
+               clEnumValN(LayoutReportFormat::Json, "json", "Machine-readable report, meant for CI")),
+    cl::init(LayoutReportFormat::None), cl::cat(s_MinimetaCategory)};
+
+static cl::opt<std::string> s_LayoutOutput{
+    "layout-output", cl::desc("File the layout report is written to, defaults to stdout"),
+    cl::value_desc("filename"), cl::init("-"), cl::cat(s_MinimetaCategory)};
+
+static cl::opt<bool> s_Watch{
+    "watch", cl::desc("Keep running and regenerate sources as soon as the files they depend on change"),
+    cl::cat(s_MinimetaCategory)};
+
+static cl::opt<bool> s_Client{
+    "client",
+    cl::desc("Wait for a running --watch instance to bring every generated source up to date, "
+             "generates them in-process if there's none"),
+    cl::cat(s_MinimetaCategory)};
+
+static cl::opt<std::string> s_WatchDirectory{
+    "watch-dir", cl::desc("Directory --watch and --client use to talk to each other"),
+    cl::value_desc("directory"), cl::init(".minimeta"), cl::cat(s_MinimetaCategory)};
+
+static cl::opt<unsigned> s_WatchInterval{
+    "watch-interval", cl::desc("How often --watch checks for changes, in milliseconds"),
+    cl::init(50), cl::cat(s_MinimetaCategory)};
+
 using namespace clang;
 using namespace clang::ast_matchers;
 
@@ -53,8 +99,36 @@ struct TypeInfo {
     printf("\n");
   }
 };
+
+// Everything is in bytes, offsets are relative to the start of the object
+struct FieldLayout {
+  std::string Name, Type;
+  uint64_t Offset = 0, Size = 0, Align = 1;
+  bool Reflected = false;
+  bool Fixed = false;    // Bases and vtable pointers can't be reordered
+  bool Virtual = false;  // Virtual bases are fixed too, but always placed after everything else
+  bool BitField = false; // Runs of adjacent bit-fields are moved as one unit
+};
+
+struct LayoutHole {
+  uint64_t Offset = 0, Size = 0;
+};
+
+struct TypeLayout {
+  std::string Name, Source;
+  uint64_t Size = 0, Align = 1;
+  std::vector<FieldLayout> Fields;
+
+  std::vector<LayoutHole> Holes; // Tail padding included
+  uint64_t WastedBytes = 0;
+  std::vector<size_t> Straddling;     // Indices into Fields
+  std::vector<size_t> SuggestedOrder; // Empty if the current order is already the tightest
+  uint64_t SuggestedSize = 0;
+};
 } // namespace mmeta
 
+static constexpr uint64_t kCacheLineSize = 64;
+
 static const std::string generatedFileHeader = R"(
 // ========================================================================-------
 // ======= This file was generated by minimeta. Don't touch it!!!!
@@ -90,6 +164,35 @@ static auto GenerateStorageSrc(const mmeta::TypeInfo& typeMeta) {
   return output.str();
 }
 
+static std::string GenerateFileSrc(const std::vector<mmeta::TypeInfo> &types) {
+  std::string source = "";
+  llvm::raw_string_ostream output { source };
+
+  output << generatedFileHeader;
+  for(const auto& typeMeta : types) {
+    output << GenerateForwardDeclSrc(typeMeta);
+    output << GenerateStorageSrc(typeMeta);
+  }
+  output << generatedFileFooter;
+
+  return output.str();
+}
+
+// Files that are already up to date are left untouched, so the build system doesn't rebuild what includes them
+static void WriteGeneratedFile(const std::string &filename, const std::string &source) {
+  if (auto current = MemoryBuffer::getFile(filename)) {
+    if ((*current)->getBuffer() == source)
+      return;
+  }
+
+  std::error_code errorCode;
+  raw_fd_ostream outputStream { filename, errorCode };
+
+  assert(!errorCode && "Couldn't open file!");
+
+  outputStream << source;
+}
+
 void GenerateTypeMetadataSource(std::vector<mmeta::TypeInfo> &types) {
   std::unordered_map<std::string, std::vector<mmeta::TypeInfo>> metadataPools;
   for (const auto &metaType : types) {
@@ -97,17 +200,7 @@ void GenerateTypeMetadataSource(std::vector<mmeta::TypeInfo> &types) {
   }
 
   for (const auto &pool : metadataPools) {
-    std::error_code errorCode;
-    raw_fd_ostream outputStream { pool.first, errorCode };
-
-    assert(!errorCode && "Couldn't open file!");
-
-    outputStream << generatedFileHeader;
-    for(const auto& typeMeta : pool.second) {
-      outputStream << GenerateForwardDeclSrc(typeMeta);
-      outputStream << GenerateStorageSrc(typeMeta);
-    }
-    outputStream << generatedFileFooter;
+    WriteGeneratedFile(pool.first, GenerateFileSrc(pool.second));
   }
 }
 
@@ -130,18 +223,309 @@ FindSerializableFields(const CXXRecordDecl *typeDecl) {
   std::vector<mmeta::FieldInfo> fields;
   for (const auto &field : typeDecl->fields()) {
     if (IsSerializableField(field)) {
+      const QualType fieldType = field->getType();
+
+      // Arrays are serialized as a block whose size comes from the type, so it must be known
+      if (fieldType->isIncompleteArrayType() || fieldType->isVariableArrayType()) {
+        llvm::errs() << llvm::formatv("warning: skipping '{0}::{1}', only fixed-size arrays can be serialized\n",
+                                      typeDecl->getNameAsString(), field->getNameAsString());
+        continue;
+      }
+
       mmeta::FieldInfo metaField;
       metaField.Name = field->getNameAsString();
-      metaField.Type = field->getType().getAsString();
+      metaField.Type = fieldType.getAsString();
       fields.push_back(metaField);
     }
   }
   return fields;
 }
 
+// ========================================================================-------
+// ======= Layout Report
+// ========================================================================-------
+
+static uint64_t AlignTo(uint64_t value, uint64_t align) {
+  return (value + align - 1) / align * align;
+}
+
+static void AnalyzeLayout(mmeta::TypeLayout &layout) {
+  std::vector<size_t> byOffset(layout.Fields.size());
+  for (size_t i = 0; i < byOffset.size(); i++)
+    byOffset[i] = i;
+  std::stable_sort(byOffset.begin(), byOffset.end(), [&](size_t a, size_t b) {
+    return layout.Fields[a].Offset < layout.Fields[b].Offset;
+  });
+
+  uint64_t end = 0;
+  for (size_t index : byOffset) {
+    const mmeta::FieldLayout &field = layout.Fields[index];
+    if (field.Offset > end)
+      layout.Holes.push_back({end, field.Offset - end});
+    end = std::max(end, field.Offset + field.Size);
+
+    if (field.Size > 0 && field.Size <= kCacheLineSize &&
+        field.Offset / kCacheLineSize != (field.Offset + field.Size - 1) / kCacheLineSize)
+      layout.Straddling.push_back(index);
+  }
+  if (layout.Size > end)
+    layout.Holes.push_back({end, layout.Size - end});
+
+  for (const auto &hole : layout.Holes)
+    layout.WastedBytes += hole.Size;
+
+  // Bases and the vtable pointer come first whatever the order, everything else is packed after them
+  // by decreasing alignment, which is the tightest order as long as sizes are multiples of their
+  // alignment. Adjacent bit-fields share storage, so each run of them is moved as a single unit that
+  // keeps its current bit arrangement. Virtual bases follow the packed fields in their current order.
+  struct Unit {
+    size_t First = 0, Count = 0;
+    uint64_t Size = 0, Align = 1;
+  };
+  std::vector<Unit> units;
+  uint64_t fixedEnd = 0;
+  std::vector<size_t> virtualBases;
+  for (size_t i = 0; i < layout.Fields.size(); i++) {
+    const mmeta::FieldLayout &field = layout.Fields[i];
+    if (field.Virtual) {
+      virtualBases.push_back(i);
+      continue;
+    }
+    if (field.Fixed) {
+      fixedEnd = std::max(fixedEnd, field.Offset + field.Size);
+      continue;
+    }
+
+    const bool extendsRun = field.BitField && !units.empty() && units.back().First + units.back().Count == i &&
+                            layout.Fields[units.back().First].BitField;
+    if (!extendsRun)
+      units.push_back({i, 0, 0, 1});
+
+    Unit &unit = units.back();
+    unit.Count++;
+    unit.Align = std::max(unit.Align, field.Align);
+    if (!field.BitField) {
+      unit.Size = field.Size;
+      continue;
+    }
+    // Measured from the storage unit the run starts in, so it fits wherever that alignment is met
+    const uint64_t runStart = layout.Fields[unit.First].Offset / unit.Align * unit.Align;
+    unit.Size = std::max(unit.Size, field.Offset + field.Size - runStart);
+  }
+  std::stable_sort(units.begin(), units.end(), [](const Unit &a, const Unit &b) { return a.Align > b.Align; });
+
+  uint64_t offset = fixedEnd;
+  std::vector<size_t> order;
+  for (const Unit &unit : units) {
+    offset = AlignTo(offset, unit.Align) + unit.Size;
+    for (size_t i = 0; i < unit.Count; i++)
+      order.push_back(unit.First + i);
+  }
+  std::stable_sort(virtualBases.begin(), virtualBases.end(), [&](size_t a, size_t b) {
+    return layout.Fields[a].Offset < layout.Fields[b].Offset;
+  });
+  for (size_t index : virtualBases) {
+    const mmeta::FieldLayout &base = layout.Fields[index];
+    offset = AlignTo(offset, base.Align) + base.Size;
+  }
+  const uint64_t packedSize = std::max<uint64_t>(AlignTo(offset, layout.Align), 1);
+
+  if (packedSize < layout.Size) {
+    layout.SuggestedOrder = std::move(order);
+    layout.SuggestedSize = packedSize;
+  }
+}
+
+static mmeta::FieldLayout MakeFieldLayout(const ASTContext &context, const ASTRecordLayout &recordLayout,
+                                          FieldDecl *field) {
+  mmeta::FieldLayout fieldLayout;
+  fieldLayout.Name = field->getNameAsString();
+  fieldLayout.Type = field->getType().getAsString();
+  fieldLayout.Reflected = IsSerializableField(field);
+
+  const uint64_t offsetInBits = recordLayout.getFieldOffset(field->getFieldIndex());
+  if (field->isBitField()) {
+    // Reported as the bytes the bit-field touches
+    const uint64_t width = field->getBitWidthValue(context);
+    fieldLayout.Offset = offsetInBits / 8;
+    fieldLayout.Size = AlignTo(offsetInBits + width, 8) / 8 - fieldLayout.Offset;
+    fieldLayout.Align = context.getTypeAlignInChars(field->getType()).getQuantity();
+    fieldLayout.BitField = true;
+    return fieldLayout;
+  }
+
+  fieldLayout.Offset = context.toCharUnitsFromBits(offsetInBits).getQuantity();
+  fieldLayout.Size = field->isZeroSize(context) ? 0 : context.getTypeSizeInChars(field->getType()).getQuantity();
+  fieldLayout.Align = context.getDeclAlign(field).getQuantity();
+  return fieldLayout;
+}
+
+static bool FindTypeLayout(const CXXRecordDecl *typeDecl, mmeta::TypeLayout &layout) {
+  const CXXRecordDecl *definition = typeDecl->getDefinition();
+  if (!definition || definition->isDependentType() || definition->isInvalidDecl()) {
+    llvm::errs() << llvm::formatv("warning: no layout report for '{0}', its layout isn't known\n",
+                                  typeDecl->getNameAsString());
+    return false;
+  }
+
+  const ASTContext &context = definition->getASTContext();
+  const ASTRecordLayout &recordLayout = context.getASTRecordLayout(definition);
+  layout.Name = definition->getQualifiedNameAsString();
+  layout.Size = recordLayout.getSize().getQuantity();
+  layout.Align = recordLayout.getAlignment().getQuantity();
+
+  if (recordLayout.hasOwnVFPtr()) {
+    mmeta::FieldLayout vptr;
+    vptr.Name = "<vptr>";
+    vptr.Type = "void *";
+    vptr.Size = vptr.Align = context.getTypeSizeInChars(context.VoidPtrTy).getQuantity();
+    vptr.Fixed = true;
+    layout.Fields.push_back(vptr);
+  }
+
+  for (const auto &base : definition->bases()) {
+    const CXXRecordDecl *baseDecl = base.getType()->getAsCXXRecordDecl();
+    if (!baseDecl || base.isVirtual() || baseDecl->isEmpty())
+      continue;
+
+    const ASTRecordLayout &baseLayout = context.getASTRecordLayout(baseDecl);
+    mmeta::FieldLayout baseField;
+    baseField.Name = "<base>";
+    baseField.Type = base.getType().getAsString();
+    baseField.Offset = recordLayout.getBaseClassOffset(baseDecl).getQuantity();
+    baseField.Size = baseLayout.getNonVirtualSize().getQuantity();
+    baseField.Align = baseLayout.getNonVirtualAlignment().getQuantity();
+    baseField.Fixed = true;
+    layout.Fields.push_back(baseField);
+  }
+
+  // Direct and indirect ones, each is laid out once in the most derived object
+  for (const auto &base : definition->vbases()) {
+    const CXXRecordDecl *baseDecl = base.getType()->getAsCXXRecordDecl();
+    if (!baseDecl || baseDecl->isEmpty())
+      continue;
+
+    const ASTRecordLayout &baseLayout = context.getASTRecordLayout(baseDecl);
+    mmeta::FieldLayout baseField;
+    baseField.Name = "<virtual base>";
+    baseField.Type = base.getType().getAsString();
+    baseField.Offset = recordLayout.getVBaseClassOffset(baseDecl).getQuantity();
+    baseField.Size = baseLayout.getNonVirtualSize().getQuantity();
+    baseField.Align = baseLayout.getNonVirtualAlignment().getQuantity();
+    baseField.Fixed = true;
+    // A nearly empty primary virtual base shares the vtable pointer at the start of the object
+    baseField.Virtual = !(recordLayout.isPrimaryBaseVirtual() && recordLayout.getPrimaryBase() == baseDecl);
+    layout.Fields.push_back(baseField);
+  }
+
+  for (auto *field : definition->fields())
+    layout.Fields.push_back(MakeFieldLayout(context, recordLayout, field));
+
+  AnalyzeLayout(layout);
+  return true;
+}
+
+static void WriteLayoutText(const std::map<std::string, mmeta::TypeLayout> &layouts, raw_ostream &output) {
+  for (const auto &entry : layouts) {
+    const mmeta::TypeLayout &layout = entry.second;
+    output << llvm::formatv("{0} ({1}): size {2}, align {3}, {4} bytes of padding\n", layout.Name, layout.Source,
+                            layout.Size, layout.Align, layout.WastedBytes);
+    output << llvm::formatv("  {0,6} {1,6} {2,6}  field\n", "offset", "size", "align");
+
+    size_t hole = 0;
+    for (size_t i = 0; i < layout.Fields.size(); i++) {
+      const mmeta::FieldLayout &field = layout.Fields[i];
+      for (; hole < layout.Holes.size() && layout.Holes[hole].Offset < field.Offset; hole++)
+        output << llvm::formatv("  {0,6} {1,6} {2,6}  <padding>\n", layout.Holes[hole].Offset,
+                                layout.Holes[hole].Size, "");
+
+      const bool straddles = std::find(layout.Straddling.begin(), layout.Straddling.end(), i) != layout.Straddling.end();
+      output << llvm::formatv("  {0,6} {1,6} {2,6}  {3} {4}{5}{6}\n", field.Offset, field.Size, field.Align,
+                              field.Type, field.Name, field.Reflected ? "" : " (not reflected)",
+                              straddles ? " [straddles a cache line]" : "");
+    }
+    for (; hole < layout.Holes.size(); hole++)
+      output << llvm::formatv("  {0,6} {1,6} {2,6}  <padding>\n", layout.Holes[hole].Offset,
+                              layout.Holes[hole].Size, "");
+
+    if (!layout.SuggestedOrder.empty()) {
+      output << llvm::formatv("  suggested order, size {0} ({1} bytes smaller):", layout.SuggestedSize,
+                              layout.Size - layout.SuggestedSize);
+      for (size_t index : layout.SuggestedOrder)
+        output << " " << layout.Fields[index].Name;
+      output << "\n";
+    }
+    output << "\n";
+  }
+}
+
+static void WriteLayoutJson(const std::map<std::string, mmeta::TypeLayout> &layouts, raw_ostream &output) {
+  json::OStream writer{output, 2};
+  writer.array([&] {
+    for (const auto &entry : layouts) {
+      const mmeta::TypeLayout &layout = entry.second;
+      writer.object([&] {
+        writer.attribute("name", layout.Name);
+        writer.attribute("source", layout.Source);
+        writer.attribute("size", static_cast<int64_t>(layout.Size));
+        writer.attribute("align", static_cast<int64_t>(layout.Align));
+        writer.attribute("wasted", static_cast<int64_t>(layout.WastedBytes));
+        writer.attributeArray("fields", [&] {
+          for (size_t i = 0; i < layout.Fields.size(); i++) {
+            const mmeta::FieldLayout &field = layout.Fields[i];
+            writer.object([&] {
+              writer.attribute("name", field.Name);
+              writer.attribute("type", field.Type);
+              writer.attribute("offset", static_cast<int64_t>(field.Offset));
+              writer.attribute("size", static_cast<int64_t>(field.Size));
+              writer.attribute("align", static_cast<int64_t>(field.Align));
+              writer.attribute("reflected", field.Reflected);
+              writer.attribute("straddlesCacheLine", std::find(layout.Straddling.begin(), layout.Straddling.end(),
+                                                             i) != layout.Straddling.end());
+            });
+          }
+        });
+        writer.attributeArray("holes", [&] {
+          for (const auto &hole : layout.Holes)
+            writer.object([&] {
+              writer.attribute("offset", static_cast<int64_t>(hole.Offset));
+              writer.attribute("size", static_cast<int64_t>(hole.Size));
+            });
+        });
+        if (!layout.SuggestedOrder.empty()) {
+          writer.attribute("suggestedSize", static_cast<int64_t>(layout.SuggestedSize));
+          writer.attributeArray("suggestedOrder", [&] {
+            for (size_t index : layout.SuggestedOrder)
+              writer.value(layout.Fields[index].Name);
+          });
+        }
+      });
+    }
+  });
+  output << "\n";
+}
+
+static bool WriteLayoutReport(const std::map<std::string, mmeta::TypeLayout> &layouts) {
+  std::error_code errorCode;
+  raw_fd_ostream outputStream{s_LayoutOutput, errorCode};
+  if (errorCode) {
+    llvm::errs() << llvm::formatv("error: couldn't open '{0}': {1}\n", s_LayoutOutput.getValue(), errorCode.message());
+    return false;
+  }
+
+  if (s_LayoutReport == LayoutReportFormat::Json)
+    WriteLayoutJson(layouts, outputStream);
+  else
+    WriteLayoutText(layouts, outputStream);
+  return true;
+}
+
 // Action that gets called when a matcher finds something
 class TypeMetaGenerator : public MatchFinder::MatchCallback {
 public:
+  // When 'writeSources' is false, found types are kept until they're taken, instead of written at the end of the TU
+  explicit TypeMetaGenerator(bool writeSources = true) : m_WriteSources(writeSources) {}
+
   virtual void run(const MatchFinder::MatchResult &result) override {
     SourceManager &sourceManager = result.Context->getSourceManager();
 
@@ -166,20 +550,349 @@ public:
 
           metaType.Fields = FindSerializableFields(typeDecl);
           m_TypeMetadata.push_back(metaType);
+
+          // Headers show up in many translation units, each type is reported once
+          if (s_LayoutReport != LayoutReportFormat::None && !m_TypeLayouts.count(typeDecl->getQualifiedNameAsString())) {
+            mmeta::TypeLayout layout;
+            layout.Source = filename;
+            if (FindTypeLayout(typeDecl, layout))
+              m_TypeLayouts.emplace(layout.Name, std::move(layout));
+          }
         }
       }
     }
   }
 
   virtual void onEndOfTranslationUnit() override {
+    if (!m_WriteSources)
+      return;
+
     printf("Found %i types in translation unit\n", (int)m_TypeMetadata.size());
     GenerateTypeMetadataSource(m_TypeMetadata);
   }
 
+  std::vector<mmeta::TypeInfo> TakeTypeMetadata() {
+    std::vector<mmeta::TypeInfo> types;
+    types.swap(m_TypeMetadata);
+    return types;
+  }
+
+  const std::map<std::string, mmeta::TypeLayout> &GetTypeLayouts() const { return m_TypeLayouts; }
+
 private:
+  bool m_WriteSources;
   std::vector<mmeta::TypeInfo> m_TypeMetadata;
+  std::map<std::string, mmeta::TypeLayout> m_TypeLayouts;
 };
 
+
+// Finds all annotated types
+static DeclarationMatcher MakeSerializableTypeMatcher() {
+  return cxxRecordDecl(decl().bind("id"), hasAttr(attr::Annotate));
+}
+
+// Adds a compiler flag that defines a macro used by the runtime
+// to preprocess code that this tool should or shouldn't compile
+static ArgumentsAdjuster MakeIgnoreGeneratedAdjuster() {
+  ArgumentsAdjuster ignoreGeneratedAdjuster;
+  ignoreGeneratedAdjuster = combineAdjusters(
+        getInsertArgumentAdjuster("-D __MMETA__", tooling::ArgumentInsertPosition::BEGIN),
+        ignoreGeneratedAdjuster);
+  return ignoreGeneratedAdjuster;
+}
+
+// ========================================================================-------
+// ======= Watch Mode
+// ========================================================================-------
+
+// --watch and --client talk through files in the watch directory, which works the same everywhere LLVM does:
+// - The server holds a lock on 'server.lock' for as long as it runs;
+// - A client creates a '.request' file and waits for the server to rename it to '.done', with the result inside.
+static const char *const kServerLockName = "server.lock";
+static const char *const kRequestExtension = ".request";
+static const char *const kDoneExtension = ".done";
+static constexpr std::chrono::milliseconds kClientPollInterval{5};
+
+static sys::TimePoint<> GetModificationTime(const std::string &filename) {
+  sys::fs::file_status status;
+  if (sys::fs::status(filename, status))
+    return {};
+  return status.getLastModificationTime();
+}
+
+static std::string GetWatchPath(StringRef name) {
+  SmallString<256> path{s_WatchDirectory.getValue()};
+  sys::path::append(path, name);
+  return path.str().str();
+}
+
+// Keeps an AST with a precompiled preamble for every source, reparsing only the ones whose files changed
+class GeneratorServer {
+public:
+  GeneratorServer(const CompilationDatabase &compilations, std::string resourceDirectory)
+      : m_Compilations(compilations), m_ResourceDirectory(std::move(resourceDirectory)),
+        m_PCHContainerOps(std::make_shared<PCHContainerOperations>()) {}
+
+  int Run(const std::vector<std::string> &sources) {
+    std::error_code errorCode = sys::fs::create_directories(s_WatchDirectory);
+    int lockFile = -1;
+    if (!errorCode)
+      errorCode = sys::fs::openFileForWrite(GetWatchPath(kServerLockName), lockFile, sys::fs::CD_OpenAlways);
+    if (!errorCode)
+      errorCode = sys::fs::tryLockFile(lockFile);
+    if (errorCode) {
+      llvm::errs() << llvm::formatv("error: couldn't start watching, is another instance using '{0}'? {1}\n",
+                                    s_WatchDirectory.getValue(), errorCode.message());
+      return 1;
+    }
+
+    for (const auto &source : sources) {
+      m_Units.emplace_back();
+      m_Units.back().Source = source;
+    }
+    printf("Watching %i sources\n", (int)m_Units.size());
+
+    while (true) {
+      const std::vector<std::string> requests = FindRequests();
+      const bool succeeded = Update();
+      for (const auto &request : requests)
+        AnswerRequest(request, succeeded);
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(s_WatchInterval));
+    }
+  }
+
+private:
+  struct TranslationUnit {
+    std::string Source;
+    std::unique_ptr<ASTUnit> AST;
+    std::vector<mmeta::TypeInfo> Types;
+    std::map<std::string, sys::TimePoint<>> Dependencies; // Non-system files it includes, and when they changed
+    bool Failed = false;
+  };
+
+  // Reparses stale sources and rewrites the generated files their types end up in, returns false while a source
+  // can't be parsed at all
+  bool Update() {
+    std::set<std::string> affectedFiles;
+
+    for (auto &unit : m_Units) {
+      if (!IsStale(unit))
+        continue;
+
+      const auto start = std::chrono::steady_clock::now();
+      for (const auto &type : unit.Types)
+        affectedFiles.insert(type.Filename);
+
+      unit.Failed = !Parse(unit);
+      if (unit.Failed)
+        continue;
+
+      for (const auto &type : unit.Types)
+        affectedFiles.insert(type.Filename);
+
+      const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+      printf("Parsed %s in %lli ms\n", unit.Source.c_str(), (long long)elapsed.count());
+    }
+
+    for (const auto &filename : affectedFiles)
+      WriteGeneratedFile(filename, GenerateFileSrc(CollectTypes(filename)));
+    return std::none_of(m_Units.begin(), m_Units.end(), [](const TranslationUnit &unit) { return unit.Failed; });
+  }
+
+  bool IsStale(const TranslationUnit &unit) const {
+    if (unit.Dependencies.empty())
+      return true;
+    for (const auto &dependency : unit.Dependencies) {
+      if (GetModificationTime(dependency.first) != dependency.second)
+        return true;
+    }
+    return false;
+  }
+
+  bool Parse(TranslationUnit &unit) {
+    // Modification times are taken before parsing, a file saved while it's being parsed is then still
+    // seen as changed on the next round
+    const sys::TimePoint<> parseStart = std::chrono::time_point_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now());
+    std::map<std::string, sys::TimePoint<>> before = std::move(unit.Dependencies);
+    before.emplace(unit.Source, sys::TimePoint<>());
+    for (auto &dependency : before)
+      dependency.second = GetModificationTime(dependency.first);
+
+    if (unit.AST) {
+      // The preamble is only rebuilt if one of the headers it covers changed
+      if (unit.AST->Reparse(m_PCHContainerOps)) {
+        unit.AST.reset();
+      }
+    }
+    else {
+      unit.AST = LoadAST(unit.Source);
+    }
+
+    if (!unit.AST) {
+      // Tried again once the source or any header it included last time changes, its previous types are
+      // still generated meanwhile
+      llvm::errs() << llvm::formatv("error: couldn't parse '{0}'\n", unit.Source);
+      unit.Dependencies = std::move(before);
+      return false;
+    }
+
+    TypeMetaGenerator generator{false};
+    MatchFinder matchFinder;
+    matchFinder.addMatcher(MakeSerializableTypeMatcher(), &generator);
+    matchFinder.matchAST(unit.AST->getASTContext());
+
+    unit.Types = generator.TakeTypeMetadata();
+    unit.Dependencies = FindDependencies(*unit.AST, before, parseStart);
+    return true;
+  }
+
+  std::unique_ptr<ASTUnit> LoadAST(const std::string &source) {
+    std::vector<CompileCommand> commands = m_Compilations.getCompileCommands(source);
+    if (commands.empty())
+      return nullptr;
+
+    ArgumentsAdjuster adjuster = combineAdjusters(
+        combineAdjusters(getClangStripOutputAdjuster(), getClangStripDependencyFileAdjuster()),
+        MakeIgnoreGeneratedAdjuster());
+    const CommandLineArguments arguments = adjuster(commands.front().CommandLine, source);
+
+    std::vector<const char *> argumentPointers;
+    for (const auto &argument : arguments)
+      argumentPointers.push_back(argument.c_str());
+
+    IntrusiveRefCntPtr<vfs::FileSystem> fileSystem = vfs::createPhysicalFileSystem();
+    fileSystem->setCurrentWorkingDirectory(commands.front().Directory);
+
+    // Function bodies never contain anything the generator needs, so they're skipped. User files are volatile,
+    // otherwise reparsing would use the sizes the files had when they were first read.
+    return std::unique_ptr<ASTUnit>(ASTUnit::LoadFromCommandLine(
+        argumentPointers.data(), argumentPointers.data() + argumentPointers.size(), m_PCHContainerOps,
+        CompilerInstance::createDiagnostics(new DiagnosticOptions()), m_ResourceDirectory,
+        /*OnlyLocalDecls=*/false, CaptureDiagsKind::None, /*RemappedFiles=*/None,
+        /*RemappedFilesKeepOriginalName=*/true, /*PrecompilePreambleAfterNParses=*/1, TU_Complete,
+        /*CacheCodeCompletionResults=*/false, /*IncludeBriefCommentsInCodeCompletion=*/false,
+        /*AllowPCHWithCompilerErrors=*/false, SkipFunctionBodiesScope::PreambleAndMainFile,
+        /*SingleFileParse=*/false, /*UserFilesAreVolatile=*/true, /*ForSerialization=*/false,
+        /*RetainExcludedConditionalBlocks=*/false, /*ModuleFormat=*/None, /*ErrAST=*/nullptr, fileSystem));
+  }
+
+  // Files in the preamble only show up as loaded entries, so both local and loaded entries are visited.
+  // Files first included by this parse weren't in the snapshot taken before it, their current time is
+  // only kept if it predates the parse, otherwise an empty time makes them stale on the next round
+  static std::map<std::string, sys::TimePoint<>>
+  FindDependencies(const ASTUnit &ast, const std::map<std::string, sys::TimePoint<>> &before,
+                   sys::TimePoint<> parseStart) {
+    const SourceManager &sourceManager = ast.getSourceManager();
+    std::map<std::string, sys::TimePoint<>> dependencies;
+
+    auto addDependency = [&](const SrcMgr::SLocEntry &entry) {
+      if (!entry.isFile() || entry.getFile().getFileCharacteristic() != SrcMgr::C_User)
+        return;
+      if (const FileEntry *file = entry.getFile().getContentCache().OrigEntry) {
+        const std::string filename = file->getName().str();
+        auto known = before.find(filename);
+        if (known != before.end()) {
+          dependencies.emplace(filename, known->second);
+          return;
+        }
+        const sys::TimePoint<> modified = GetModificationTime(filename);
+        dependencies.emplace(filename, modified < parseStart ? modified : sys::TimePoint<>());
+      }
+    };
+
+    for (unsigned i = 0; i < sourceManager.local_sloc_entry_size(); i++)
+      addDependency(sourceManager.getLocalSLocEntry(i));
+    for (unsigned i = 0; i < sourceManager.loaded_sloc_entry_size(); i++)
+      addDependency(sourceManager.getLoadedSLocEntry(i));
+    return dependencies;
+  }
+
+  // A header can be included by many sources, its types are only generated once
+  std::vector<mmeta::TypeInfo> CollectTypes(const std::string &filename) const {
+    std::vector<mmeta::TypeInfo> types;
+    std::set<std::string> names;
+    for (const auto &unit : m_Units) {
+      for (const auto &type : unit.Types) {
+        if (type.Filename == filename && names.insert(type.Name).second)
+          types.push_back(type);
+      }
+    }
+    return types;
+  }
+
+  std::vector<std::string> FindRequests() const {
+    std::vector<std::string> requests;
+    std::error_code errorCode;
+    for (sys::fs::directory_iterator it{s_WatchDirectory, errorCode}, end; it != end && !errorCode;
+         it.increment(errorCode)) {
+      if (sys::path::extension(it->path()) == kRequestExtension)
+        requests.push_back(it->path());
+    }
+    return requests;
+  }
+
+  static void AnswerRequest(const std::string &request, bool succeeded) {
+    {
+      std::error_code errorCode;
+      raw_fd_ostream output{request, errorCode};
+      output << (succeeded ? "ok" : "failed");
+    }
+
+    SmallString<256> done{request};
+    sys::path::replace_extension(done, kDoneExtension);
+    sys::fs::rename(request, done);
+  }
+
+  const CompilationDatabase &m_Compilations;
+  const std::string m_ResourceDirectory;
+  std::shared_ptr<PCHContainerOperations> m_PCHContainerOps;
+  std::vector<TranslationUnit> m_Units;
+};
+
+enum class ClientResult { Succeeded, Failed, NoServer };
+
+// The lock is released by the OS when the server exits, however it exits
+static bool IsServerRunning() {
+  int lockFile = -1;
+  if (sys::fs::openFileForWrite(GetWatchPath(kServerLockName), lockFile, sys::fs::CD_OpenExisting))
+    return false;
+
+  const bool running = static_cast<bool>(sys::fs::tryLockFile(lockFile));
+  if (!running)
+    sys::fs::unlockFile(lockFile);
+  sys::Process::SafelyCloseFileDescriptor(lockFile);
+  return running;
+}
+
+// Blocks until the server has picked up every change made before the call
+static ClientResult RequestGeneration() {
+  if (!IsServerRunning())
+    return ClientResult::NoServer;
+
+  int requestFile = -1;
+  SmallString<256> request;
+  if (sys::fs::createUniqueFile(GetWatchPath(std::string("%%%%%%%%") + kRequestExtension), requestFile, request))
+    return ClientResult::NoServer;
+  sys::Process::SafelyCloseFileDescriptor(requestFile);
+
+  SmallString<256> done{request};
+  sys::path::replace_extension(done, kDoneExtension);
+  while (!sys::fs::exists(done)) {
+    if (!IsServerRunning()) {
+      sys::fs::remove(request);
+      return ClientResult::NoServer;
+    }
+    std::this_thread::sleep_for(kClientPollInterval);
+  }
+
+  auto answer = MemoryBuffer::getFile(done);
+  const bool succeeded = answer && (*answer)->getBuffer() == "ok";
+  sys::fs::remove(done);
+  return succeeded ? ClientResult::Succeeded : ClientResult::Failed;
+}
+
 int main(int argc, const char **argv) {
   auto expectedParser =
       CommonOptionsParser::create(argc, argv, s_MinimetaCategory);
@@ -190,24 +903,31 @@ int main(int argc, const char **argv) {
   }
 
   CommonOptionsParser &optionsParser = expectedParser.get();
-  ClangTool tool{optionsParser.getCompilations(),
-                       optionsParser.getSourcePathList()};
 
-  // Adds a compiler flag that defines a macro used by the runtime
-  // to preprocess code that this tool should or shouldn't compile
-  ArgumentsAdjuster ignoreGeneratedAdjuster;
-  ignoreGeneratedAdjuster = combineAdjusters(
-        getInsertArgumentAdjuster("-D __MMETA__", tooling::ArgumentInsertPosition::BEGIN),
-        ignoreGeneratedAdjuster);
-  tool.appendArgumentsAdjuster(ignoreGeneratedAdjuster);
+  if (s_Watch) {
+    static int s_StaticSymbol;
+    GeneratorServer server{optionsParser.getCompilations(),
+                           CompilerInvocation::GetResourcesPath(argv[0], &s_StaticSymbol)};
+    return server.Run(optionsParser.getSourcePathList());
+  }
+
+  // Without a server, the client generates everything itself
+  if (s_Client) {
+    const ClientResult result = RequestGeneration();
+    if (result != ClientResult::NoServer)
+      return result == ClientResult::Succeeded ? 0 : 1;
+  }
 
-  // Finds all annotated types
-  auto serializableTypeMatcher =
-      cxxRecordDecl(decl().bind("id"), hasAttr(attr::Annotate));
+  ClangTool tool{optionsParser.getCompilations(),
+                       optionsParser.getSourcePathList()};
+  tool.appendArgumentsAdjuster(MakeIgnoreGeneratedAdjuster());
 
   MatchFinder matchFinder;
   TypeMetaGenerator generator;
-  matchFinder.addMatcher(serializableTypeMatcher, &generator);
+  matchFinder.addMatcher(MakeSerializableTypeMatcher(), &generator);
 
   tool.run(newFrontendActionFactory(&matchFinder).get());
+
+  if (s_LayoutReport != LayoutReportFormat::None && !WriteLayoutReport(generator.GetTypeLayouts()))
+    return 1;
 }
@@ -2,6 +2,7 @@
 #include "Examples.h"
 
 #include <mmeta/minimeta.hpp>
+#include <mmeta/soa_vector.hpp>
 
 int main() {
     // compile-time type metadata
@@ -21,6 +22,32 @@ int main() {
     static_assert(mmeta::is_serializable_v<std::vector<std::vector<int>>> && "Nested std::vectors must be serializable");
     static_assert(mmeta::is_serializable_v<std::string> && "std::string must be serializable");
     static_assert(mmeta::classmeta_v<Math::Vec3>.version() != mmeta::classmeta_v<ColorRGB>.version() && "Binary serializer is versioned using hashes.");
+    static_assert(mmeta::field_index<Math::Vec3>("Y") == 1 && "Fields can be found by name in O(1), even at compile-time");
+    static_assert(mmeta::field_index<Math::Vec3>("W") == mmeta::invalid_field_index && "Unknown names aren't mapped to any field");
+
+    // runtime field access by name
+    {
+        Math::Vec3 vec;
+        const mmeta::mmfield* yField = mmeta::classmeta_v<Math::Vec3>.find_field("Y");
+        yField->set<float>(&vec, 42.f);
+        yField->get<float>(&vec) += 1.f;
+        vec.Dump();
+    }
+
+    // structure of arrays, each fundamental leaf of Transform is stored in its own array
+    {
+        mmeta::soa_vector<Transform> transforms;
+        for(int i = 0; i < 4; i++) {
+            transforms.push_back({ { float(i), 0.f, 0.f }, 0.f });
+        }
+
+        for(float& x : transforms.column<float>("Position.X")) {
+            x *= 10.f;
+        }
+
+        Transform last = transforms[3];
+        last.Position.Dump();
+    }
 
     // binary/yaml serialization
     mmeta::binary_buffer dataBuffer;
@@ -0,0 +1,85 @@
+#include "Components.h"
+
+#include <mmeta/compression.hpp>
+
+#include <chrono>
+#include <sstream>
+
+using bench_clock = std::chrono::steady_clock;
+
+static double elapsed_ms(bench_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+static const char *level_name(mmeta::compression_level level) {
+    return level == mmeta::compression_level::fast ? "fast" : "high";
+}
+
+int main(int argc, char **argv) {
+    const size_t playerCount = argc > 1 ? size_t(atol(argv[1])) : 20000;
+    const int repetitions = argc > 2 ? atoi(argv[2]) : 5;
+
+    std::vector<Player> world(playerCount);
+    for(size_t i = 0; i < world.size(); i++) {
+        Player& player = world[i];
+        player.m_id = int(i);
+        player.m_integers = { 1, 2, 3, int(i % 7) };
+        player.m_nested = { { 1.f, 2.f }, { float(i % 5) } };
+        player.m_targets = { { 1.f, 2.f, 3.f }, { float(i % 11), 0.f, 0.f } };
+        player.SetName(i % 3 ? "Paiva" : "Player");
+        player.SetPosition({ float(i % 100), 1.f, 2.f });
+    }
+
+    // Best of 'repetitions' for every step, the first run also pays for page faults
+    double serializeMs = 1e9;
+    std::string raw;
+    for(int rep = 0; rep < repetitions; rep++) {
+        std::stringstream sink;
+        const auto start = bench_clock::now();
+        for(const Player& player : world) mmeta::serialize(player, sink);
+        serializeMs = std::min(serializeMs, elapsed_ms(start));
+        raw = sink.str();
+    }
+    printf("%zu players, %zu bytes raw, serialize %.2f ms\n", world.size(), raw.size(), serializeMs);
+
+    for(mmeta::compression_level level : { mmeta::compression_level::fast, mmeta::compression_level::high }) {
+        double compressMs = 1e9, readMs = 1e9, blocksMs = 1e9;
+        std::string compressed;
+        bool roundtrip = true;
+
+        for(int rep = 0; rep < repetitions; rep++) {
+            std::stringstream sink;
+            auto start = bench_clock::now();
+            {
+                mmeta::compressed_buffer_write to { sink, level };
+                for(const Player& player : world) mmeta::serialize(player, to);
+            }
+            compressMs = std::min(compressMs, elapsed_ms(start));
+            compressed = sink.str();
+
+            std::stringstream source { compressed };
+            start = bench_clock::now();
+            {
+                mmeta::compressed_buffer_read from { source };
+                for(const Player& expected : world) {
+                    const Player player = mmeta::deserialize<Player>(from);
+                    roundtrip &= mmeta::equal(player, expected);
+                }
+            }
+            readMs = std::min(readMs, elapsed_ms(start));
+
+            // Blocks are independent, this is the single-threaded cost of the parallel path
+            const std::vector<mmeta::compressed_block> blocks = mmeta::find_compressed_blocks(compressed.data(), compressed.size());
+            std::string decompressed(raw.size(), '\0');
+            start = bench_clock::now();
+            for(const mmeta::compressed_block& block : blocks) roundtrip &= block.decompress(&decompressed[block.RawOffset]);
+            blocksMs = std::min(blocksMs, elapsed_ms(start));
+            roundtrip &= decompressed == raw;
+        }
+
+        printf("%s: %zu bytes (%.1f%%), serialize+compress %.2f ms, decompress+deserialize %.2f ms, "
+               "decompress blocks %.2f ms (%.0f MB/s)%s\n",
+               level_name(level), compressed.size(), 100.0 * double(compressed.size()) / double(raw.size()),
+               compressMs, readMs, blocksMs, double(raw.size()) / 1000.0 / blocksMs, roundtrip ? "" : "  (MISMATCH)");
+    }
+}
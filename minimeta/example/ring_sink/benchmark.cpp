@@ -0,0 +1,134 @@
+#include "Components.h"
+
+#include <mmeta/ring_sink.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using bench_clock = std::chrono::steady_clock;
+
+static double elapsed_ms(bench_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+// Every producer pushes 'perProducer' Vec3 records tagged with its index and sequence number,
+// the consumer checks that each producer's records arrive in order
+struct run_result {
+    double Milliseconds = 0;
+    bool Ordered = true;
+};
+
+static run_result run_ring(int producers, long perProducer, size_t capacity, bool decode) {
+    mmeta::mpsc_ring_sink ring { capacity };
+    std::atomic<bool> start { false };
+    std::vector<std::thread> threads;
+    for(int t = 0; t < producers; t++) {
+        threads.emplace_back([&, t] {
+            while(!start.load(std::memory_order_acquire)) std::this_thread::yield();
+            Math::Vec3 record { float(t), 0.f, 0.f };
+            for(long i = 0; i < perProducer; i++) {
+                record.Y = float(i);
+                ring.push(record);
+            }
+        });
+    }
+
+    run_result result;
+    std::vector<long> last(producers, -1);
+    const long total = perProducer * producers;
+    long received = 0;
+
+    const auto begin = bench_clock::now();
+    start.store(true, std::memory_order_release);
+    while(received < total) {
+        const size_t drained = ring.drain([&](const mmeta::ring_record& record) {
+            if(!decode) return;
+            const Math::Vec3 value = record.decode<Math::Vec3>();
+            long& previous = last[size_t(value.X)];
+            result.Ordered &= long(value.Y) > previous;
+            previous = long(value.Y);
+        });
+        if(drained == 0) std::this_thread::yield();
+        received += long(drained);
+    }
+    result.Milliseconds = elapsed_ms(begin);
+
+    for(auto& thread : threads) thread.join();
+    return result;
+}
+
+// Baseline: every record is serialized into its own string and queued under a mutex
+static run_result run_mutex(int producers, long perProducer) {
+    std::mutex lock;
+    std::deque<std::string> queue;
+    std::atomic<bool> start { false };
+    std::vector<std::thread> threads;
+    for(int t = 0; t < producers; t++) {
+        threads.emplace_back([&, t] {
+            while(!start.load(std::memory_order_acquire)) std::this_thread::yield();
+            Math::Vec3 record { float(t), 0.f, 0.f };
+            for(long i = 0; i < perProducer; i++) {
+                record.Y = float(i);
+                std::stringstream encoded;
+                mmeta::serialize(record, encoded);
+                std::lock_guard<std::mutex> guard { lock };
+                queue.push_back(encoded.str());
+            }
+        });
+    }
+
+    run_result result;
+    std::vector<long> last(producers, -1);
+    const long total = perProducer * producers;
+    long received = 0;
+
+    const auto begin = bench_clock::now();
+    start.store(true, std::memory_order_release);
+    while(received < total) {
+        std::deque<std::string> batch;
+        {
+            std::lock_guard<std::mutex> guard { lock };
+            batch.swap(queue);
+        }
+        if(batch.empty()) std::this_thread::yield();
+        for(const std::string& bytes : batch) {
+            std::stringstream encoded { bytes };
+            const Math::Vec3 value = mmeta::deserialize<Math::Vec3>(encoded);
+            long& previous = last[size_t(value.X)];
+            result.Ordered &= long(value.Y) > previous;
+            previous = long(value.Y);
+            received++;
+        }
+    }
+    result.Milliseconds = elapsed_ms(begin);
+
+    for(auto& thread : threads) thread.join();
+    return result;
+}
+
+int main(int argc, char **argv) {
+    const long records = argc > 1 ? atol(argv[1]) : 2000000;
+    const size_t capacity = argc > 2 ? size_t(atol(argv[2])) : size_t(1) << 20;
+
+    const unsigned cores = std::thread::hardware_concurrency();
+    printf("%ld Math::Vec3 records, %zu byte ring, %u hardware threads\n", records, capacity, cores);
+    printf("producers  ring (drain only)  ring (+decode)  mutex + stringstream\n");
+
+    for(int producers : { 1, 4, 16 }) {
+        const long perProducer = records / producers;
+        const double total = double(perProducer * producers);
+
+        const run_result drainOnly = run_ring(producers, perProducer, capacity, false);
+        const run_result decoded = run_ring(producers, perProducer, capacity, true);
+        const run_result baseline = run_mutex(producers, perProducer);
+
+        printf("%9d  %11.2f M rec/s  %9.2f M rec/s  %14.2f M rec/s%s%s\n", producers,
+               total / drainOnly.Milliseconds / 1000, total / decoded.Milliseconds / 1000, total / baseline.Milliseconds / 1000,
+               decoded.Ordered && baseline.Ordered ? "" : "  (out of order!)",
+               unsigned(producers) + 1 > cores ? "  (oversubscribed)" : "");
+    }
+}
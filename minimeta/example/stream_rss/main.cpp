@@ -0,0 +1,53 @@
+#include <mmeta/minimeta.hpp>
+#include <mmeta/stream_writer.hpp>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+// Peak resident set size of the process, in bytes
+static size_t peak_rss() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    #if defined(__APPLE__)
+    return size_t(usage.ru_maxrss);
+    #else
+    return size_t(usage.ru_maxrss) * 1024;
+    #endif
+#endif
+}
+
+// Serializes ~256 MB through a chunked stream and fails if peak RSS grows by more than a few chunks,
+// which is what happens when the encoding ends up buffered somewhere
+int main(int argc, char **argv) {
+    const size_t rows = argc > 1 ? size_t(atol(argv[1])) : 4000;
+    const size_t allowedGrowth = size_t(8) << 20;
+
+    std::vector<std::vector<float>> values(rows, std::vector<float>(16 * 1024, 1.5f));
+    const size_t before = peak_rss();
+
+    size_t written = 0;
+    mmeta::chunked_buffer_write output([&](const mmeta::binary_buffer_type*, size_t size) {
+        written += size;
+        return true;
+    });
+    mmeta::serialize(values, output);
+    const bool closed = output.close();
+
+    const size_t growth = peak_rss() - before;
+    printf("wrote %zu MB, peak RSS grew by %zu KB (allowed %zu KB)\n", written >> 20, growth >> 10, allowedGrowth >> 10);
+
+    if(!closed || growth > allowedGrowth) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
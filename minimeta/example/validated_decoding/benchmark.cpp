@@ -0,0 +1,71 @@
+#include "Components.h"
+
+#include <mmeta/minimeta.hpp>
+
+#include <chrono>
+#include <random>
+
+using bench_clock = std::chrono::steady_clock;
+
+static double elapsed_ms(bench_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    const long mutations = argc > 1 ? atol(argv[1]) : 100000;
+
+    std::vector<Player> world(2000);
+    for(size_t i = 0; i < world.size(); i++) {
+        world[i].m_id = int(i);
+        world[i].m_integers = { 1, 2, int(i) };
+        world[i].SetName("player" + std::to_string(i));
+    }
+
+    mmeta::memory_buffer_write encoded;
+    mmeta::serialize(world, encoded);
+    printf("%zu players, %zu bytes\n", world.size(), encoded.size());
+
+    // trusting istream path vs validated path over the same bytes
+    for(int rep = 0; rep < 5; rep++) {
+        auto start = bench_clock::now();
+        {
+            mmeta::memory_buffer_read input { encoded.data(), encoded.size() };
+            std::vector<Player> players = mmeta::deserialize<std::vector<Player>>(input);
+        }
+        const double trusting = elapsed_ms(start);
+
+        start = bench_clock::now();
+        std::vector<Player> players;
+        const mmeta::decode_error error = mmeta::deserialize_validated(encoded.data(), encoded.size(), players);
+        const double validated = elapsed_ms(start);
+
+        printf("trusting %.3f ms, validated %.3f ms (error %d)\n", trusting, validated, int(error));
+    }
+
+    // random byte flips and truncations of a small world, every one has to be decoded or rejected
+    std::vector<Player> small(world.begin(), world.begin() + 4);
+    mmeta::memory_buffer_write smallEncoded;
+    mmeta::serialize(small, smallEncoded);
+    const std::string original(smallEncoded.data(), smallEncoded.size());
+
+    std::mt19937_64 random { 1 };
+    long errors[8] = {};
+    for(long i = 0; i < mutations; i++) {
+        std::string mutated = original;
+        const int edits = 1 + int(random() % 8);
+        for(int edit = 0; edit < edits && !mutated.empty(); edit++) {
+            const size_t position = random() % mutated.size();
+            switch(random() % 3) {
+                case 0: mutated[position] = char(random()); break;
+                case 1: mutated[position] = char(0xff); break;
+                default: mutated.resize(position); break;
+            }
+        }
+
+        std::vector<Player> decoded;
+        errors[int(mmeta::deserialize_validated(mutated.data(), mutated.size(), decoded, { size_t(16) << 20, 16 }))]++;
+    }
+
+    printf("%ld mutations: decoded %ld, truncated %ld, version %ld, length %ld, allocation %ld, depth %ld, tag %ld, mismatch %ld\n",
+           mutations, errors[0], errors[1], errors[2], errors[3], errors[4], errors[5], errors[6], errors[7]);
+}
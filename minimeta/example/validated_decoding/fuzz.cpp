@@ -0,0 +1,38 @@
+#include "Components.h"
+
+#include <mmeta/minimeta.hpp>
+#include <mmeta/soa_vector.hpp>
+
+#include <map>
+#include <optional>
+#include <variant>
+
+// libFuzzer entry point, e.g:
+//      ./validated-decoding-fuzz -max_len=4096 corpus/
+// Any input must either decode or be rejected with an error, without crashing or going over the limits.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const mmeta::binary_buffer_type *bytes = reinterpret_cast<const mmeta::binary_buffer_type*>(data);
+    const mmeta::decode_limits limits { size_t(16) << 20, 16 };
+
+    {
+        std::vector<Player> players;
+        mmeta::deserialize_validated(bytes, size, players, limits);
+    }
+    {
+        std::map<std::string, std::vector<Math::Vec3>> groups;
+        mmeta::deserialize_validated(bytes, size, groups, limits);
+    }
+    {
+        std::vector<std::variant<int, std::string, std::optional<Math::Vec3>>> values;
+        mmeta::deserialize_validated(bytes, size, values, limits);
+    }
+    {
+        mmeta::soa_vector<Transform> transforms;
+        mmeta::deserialize_validated(bytes, size, transforms, limits);
+    }
+    {
+        std::vector<std::array<int, 0>> empty;
+        mmeta::deserialize_validated(bytes, size, empty, limits);
+    }
+    return 0;
+}
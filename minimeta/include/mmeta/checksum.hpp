@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "minimeta.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <nmmintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #endif
+    #define MMETA_CRC32C_X86
+#elif defined(__ARM_FEATURE_CRC32)
+    #include <arm_acle.h>
+    #define MMETA_CRC32C_ARM
+#endif
+
+#if defined(MMETA_CRC32C_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define MMETA_TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+    #define MMETA_TARGET_SSE42
+#endif
+
+namespace mmeta {
+    // ========================================================================-------
+    // ======= CRC32C
+    // ========================================================================-------
+
+    namespace crc {
+        static constexpr uint32_t kCastagnoliPolynomial = 0x82F63B78;    // Reflected
+
+        struct slice_tables {
+            uint32_t Table[8][256];
+        };
+
+        constexpr slice_tables make_slice_tables() {
+            slice_tables tables{};
+            for(uint32_t i = 0; i < 256; i++) {
+                uint32_t crc = i;
+                for(int bit = 0; bit < 8; bit++) {
+                    crc = (crc >> 1) ^ ((crc & 1) ? kCastagnoliPolynomial : 0);
+                }
+                tables.Table[0][i] = crc;
+            }
+            for(uint32_t i = 0; i < 256; i++) {
+                for(int slice = 1; slice < 8; slice++) {
+                    const uint32_t previous = tables.Table[slice - 1][i];
+                    tables.Table[slice][i] = (previous >> 8) ^ tables.Table[0][previous & 0xFF];
+                }
+            }
+            return tables;
+        }
+
+        inline constexpr slice_tables kSliceTables = make_slice_tables();
+
+        // Slicing-by-8 fallback, processes 8 bytes per iteration with table lookups
+        inline uint32_t extend_sliced(uint32_t crc, const uint8_t *data, size_t size) {
+            const auto& t = kSliceTables.Table;
+            for(; size >= 8; size -= 8, data += 8) {
+                uint32_t low, high;
+                memcpy(&low, data, sizeof(low));
+                memcpy(&high, data + 4, sizeof(high));
+                low ^= crc;
+                crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+                      t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+            }
+            for(; size > 0; size--, data++) {
+                crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xFF];
+            }
+            return crc;
+        }
+
+#if defined(MMETA_CRC32C_X86)
+        MMETA_TARGET_SSE42 inline uint32_t extend_hardware(uint32_t crc, const uint8_t *data, size_t size) {
+            uint64_t crc64 = crc;
+            for(; size >= 8; size -= 8, data += 8) {
+                uint64_t value;
+                memcpy(&value, data, sizeof(value));
+                crc64 = _mm_crc32_u64(crc64, value);
+            }
+            crc = static_cast<uint32_t>(crc64);
+            for(; size > 0; size--, data++) {
+                crc = _mm_crc32_u8(crc, *data);
+            }
+            return crc;
+        }
+
+        inline bool has_hardware_support() {
+    #if defined(__SSE4_2__)
+            return true;
+    #elif defined(_MSC_VER) && !defined(__clang__)
+            static const bool supported = [] {
+                int info[4];
+                __cpuid(info, 1);
+                return (info[2] & BIT(20)) != 0;
+            }();
+            return supported;
+    #else
+            static const bool supported = __builtin_cpu_supports("sse4.2");
+            return supported;
+    #endif
+        }
+#elif defined(MMETA_CRC32C_ARM)
+        inline uint32_t extend_hardware(uint32_t crc, const uint8_t *data, size_t size) {
+            for(; size >= 8; size -= 8, data += 8) {
+                uint64_t value;
+                memcpy(&value, data, sizeof(value));
+                crc = __crc32cd(crc, value);
+            }
+            for(; size > 0; size--, data++) {
+                crc = __crc32cb(crc, *data);
+            }
+            return crc;
+        }
+
+        inline bool has_hardware_support() { return true; }
+#else
+        inline uint32_t extend_hardware(uint32_t crc, const uint8_t *data, size_t size) { return extend_sliced(crc, data, size); }
+
+        inline bool has_hardware_support() { return false; }
+#endif
+    }
+
+    // CRC32C (Castagnoli) of 'data'. Pass the CRC of the previous chunk to checksum data in pieces.
+    inline uint32_t crc32c(const void *data, size_t size, uint32_t crc = 0) {
+        const uint8_t *bytes = static_cast<const uint8_t*>(data);
+        crc = ~crc;
+        crc = crc::has_hardware_support() ? crc::extend_hardware(crc, bytes, size) : crc::extend_sliced(crc, bytes, size);
+        return ~crc;
+    }
+
+    // ========================================================================-------
+    // ======= Framed Serialization
+    // ========================================================================-------
+
+    // Frame: [payload size: u64][payload crc: u32][header crc: u32][payload]
+    // The header crc covers the size, so a corrupted size is caught before anything is allocated.
+    struct frame_header {
+        uint64_t Size;
+        uint32_t PayloadCRC;
+        uint32_t HeaderCRC;
+    };
+
+    enum class frame_status {
+        ok,
+        truncated,          // Stream ended before the frame did
+        corrupted,          // Checksum mismatch
+        too_large,          // Frame is bigger than the reader allows
+        version_mismatch    // Frame is intact, but was written by a different version of the class
+    };
+
+    static constexpr uint64_t kDefaultMaxFrameSize = uint64_t(1) << 30;
+
+    inline void write_frame(const binary_buffer_type *payload, size_t size, binary_buffer_write& to) {
+        frame_header header { size, crc32c(payload, size), 0 };
+        header.HeaderCRC = crc32c(&header, offsetof(frame_header, HeaderCRC));
+
+        to.write(reinterpret_cast<const binary_buffer_type*>(&header), sizeof(header));
+        to.write(payload, size);
+    }
+
+    // Reads a whole frame into 'payload' and verifies it, without decoding anything
+    inline frame_status read_frame(binary_buffer_read& from, std::vector<binary_buffer_type>& payload, uint64_t maxSize = kDefaultMaxFrameSize) {
+        frame_header header;
+        if(!from.read(reinterpret_cast<binary_buffer_type*>(&header), sizeof(header))) {
+            return frame_status::truncated;
+        }
+        if(header.HeaderCRC != crc32c(&header, offsetof(frame_header, HeaderCRC))) {
+            return frame_status::corrupted;
+        }
+        if(header.Size > maxSize) {
+            return frame_status::too_large;
+        }
+
+        payload.resize(static_cast<size_t>(header.Size));
+        if(!from.read(payload.data(), payload.size())) {
+            return frame_status::truncated;
+        }
+        return crc32c(payload.data(), payload.size()) == header.PayloadCRC ? frame_status::ok : frame_status::corrupted;
+    }
+
+    // Keeps its payload buffer around, so writing many frames doesn't allocate
+    class frame_writer {
+    public:
+        template <typename T>
+        std::enable_if_t<is_serializable_v<T>>
+        write(const T& value, binary_buffer_write& to) {
+            m_payload.clear();
+            serialize(value, m_payload);
+            write_frame(m_payload.data(), m_payload.size(), to);
+        }
+
+    private:
+        memory_buffer_write m_payload;
+    };
+
+    class frame_reader {
+    public:
+        explicit frame_reader(uint64_t maxFrameSize = kDefaultMaxFrameSize) : m_maxFrameSize(maxFrameSize) {}
+
+        // The whole frame is verified before it's decoded, 'value' is only touched if the frame is ok
+        template <typename T>
+        std::enable_if_t<is_serializable_v<T>, frame_status>
+        read(binary_buffer_read& from, T& value) {
+            const frame_status status = read_frame(from, m_payload, m_maxFrameSize);
+            if(status != frame_status::ok) {
+                return status;
+            }
+
+            if constexpr (is_hashed_type_v<T>) {
+                hash_type version = 0;
+                if(m_payload.size() < sizeof(version)) {
+                    return frame_status::truncated;
+                }
+                memcpy(&version, m_payload.data(), sizeof(version));
+                if(version != classmeta_v<T>.version()) {
+                    return frame_status::version_mismatch;
+                }
+            }
+
+            memory_buffer_read payload { m_payload.data(), m_payload.size() };
+            mmeta::read<T>(nullptr, payload, &value);
+            return frame_status::ok;
+        }
+
+    private:
+        uint64_t m_maxFrameSize;
+        std::vector<binary_buffer_type> m_payload;
+    };
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>>
+    serialize_framed(const T& value, binary_buffer_write& to) {
+        frame_writer writer;
+        writer.write(value, to);
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, frame_status>
+    deserialize_framed(binary_buffer_read& from, T& value, uint64_t maxFrameSize = kDefaultMaxFrameSize) {
+        frame_reader reader { maxFrameSize };
+        return reader.read(from, value);
+    }
+}
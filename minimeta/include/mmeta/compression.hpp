@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <streambuf>
+#include <vector>
+
+#include "minimeta.hpp"
+
+// Dependency-free LZ77 block compression, in the spirit of LZ4. Data is split into fixed-size blocks that
+// are compressed independently, so they can be streamed and decompressed in parallel.
+//
+// Block frame: [raw size: u32][stored size: u32][payload]
+//  - stored size == raw size means the block was incompressible and is stored as is;
+//  - a raw size of 0 marks the end of the stream.
+//
+// Payload is a sequence of [token][literal length+][literals][offset: u16][match length+], where the token
+// holds the literal length on its upper nibble and the match length (minus 4) on the lower one. Lengths
+// of 15 or more continue on the following bytes. The last sequence only has literals.
+namespace mmeta {
+    enum class compression_level {
+        fast,       // Single hash probe and skipping over incompressible data
+        high        // Hash chains, slower but finds longer matches
+    };
+
+    namespace lz {
+        static constexpr size_t kMinMatch = 4;
+        static constexpr size_t kMaxOffset = 65535;
+        static constexpr size_t kFastHashBits = 14;
+        static constexpr size_t kHighHashBits = 16;
+        static constexpr int kHighMaxProbes = 64;
+        static constexpr size_t kHighGoodLength = 256;     // Matches this long stop the search early
+
+        inline uint32_t read32(const uint8_t *ptr) {
+            uint32_t value;
+            memcpy(&value, ptr, sizeof(value));
+            return value;
+        }
+
+        inline size_t hash4(uint32_t sequence, size_t bits) {
+            return static_cast<size_t>((sequence * 2654435761u) >> (32 - bits));
+        }
+
+        inline size_t compress_bound(size_t size) {
+            return size + size / 255 + 16;
+        }
+
+        inline void write_length(uint8_t *&out, size_t length) {
+            for(length -= 15; length >= 255; length -= 255) {
+                *out++ = 255;
+            }
+            *out++ = static_cast<uint8_t>(length);
+        }
+
+        inline bool read_length(const uint8_t *&in, const uint8_t *end, size_t& length) {
+            uint8_t byte = 255;
+            while(byte == 255) {
+                if(in >= end) return false;
+                byte = *in++;
+                length += byte;
+            }
+            return true;
+        }
+
+        inline void write_sequence(uint8_t *&out, const uint8_t *literals, size_t literalLength, size_t offset, size_t matchLength) {
+            const size_t matchCode = matchLength > 0 ? matchLength - kMinMatch : 0;
+            *out++ = static_cast<uint8_t>(((literalLength < 15 ? literalLength : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+            if(literalLength >= 15) write_length(out, literalLength);
+
+            memcpy(out, literals, literalLength);
+            out += literalLength;
+
+            if(matchLength == 0) return;
+            *out++ = static_cast<uint8_t>(offset & 0xFF);
+            *out++ = static_cast<uint8_t>(offset >> 8);
+            if(matchCode >= 15) write_length(out, matchCode);
+        }
+
+        // Keeps the match finder tables around, so they're not reallocated for every block
+        class compressor {
+        public:
+            explicit compressor(compression_level level = compression_level::fast) : m_level(level) {
+                m_head.resize(size_t(1) << hash_bits());
+            }
+
+            // 'to' must have room for compress_bound(size) bytes. Returns the compressed size.
+            size_t compress(const uint8_t *from, size_t size, uint8_t *to) {
+                const bool high = m_level == compression_level::high;
+                const size_t bits = hash_bits();
+                std::fill(m_head.begin(), m_head.end(), -1);
+                if(high && m_chain.size() < size) m_chain.resize(size);
+
+                auto insert = [&](size_t pos) {
+                    const size_t h = hash4(read32(from + pos), bits);
+                    const int32_t previous = m_head[h];
+                    m_head[h] = static_cast<int32_t>(pos);
+                    if(high) m_chain[pos] = previous;
+                    return previous;
+                };
+
+                uint8_t *out = to;
+                size_t pos = 0, anchor = 0, misses = 0;
+                while(pos + kMinMatch <= size) {
+                    int32_t candidate = insert(pos);
+
+                    size_t bestLength = 0, bestOffset = 0;
+                    for(int probes = high ? kHighMaxProbes : 1; candidate >= 0 && probes > 0 && pos - static_cast<size_t>(candidate) <= kMaxOffset; probes--) {
+                        if(read32(from + candidate) == read32(from + pos)) {
+                            size_t length = kMinMatch;
+                            while(pos + length < size && from[candidate + length] == from[pos + length]) length++;
+                            if(length > bestLength) {
+                                bestLength = length;
+                                bestOffset = pos - candidate;
+                                if(length >= kHighGoodLength) break;
+                            }
+                        }
+                        candidate = high ? m_chain[candidate] : -1;
+                    }
+
+                    if(bestLength < kMinMatch) {
+                        // Fast mode speeds up over data that doesn't seem to compress
+                        pos += high ? 1 : 1 + (misses++ >> 5);
+                        continue;
+                    }
+
+                    write_sequence(out, from + anchor, pos - anchor, bestOffset, bestLength);
+                    if(high) {
+                        for(size_t inner = pos + 1; inner < pos + bestLength && inner + kMinMatch <= size; inner++) insert(inner);
+                    }
+                    pos += bestLength;
+                    anchor = pos;
+                    misses = 0;
+                }
+
+                write_sequence(out, from + anchor, size - anchor, 0, 0);
+                return static_cast<size_t>(out - to);
+            }
+
+        private:
+            size_t hash_bits() const { return m_level == compression_level::high ? kHighHashBits : kFastHashBits; }
+
+            compression_level m_level;
+            std::vector<int32_t> m_head;
+            std::vector<int32_t> m_chain;
+        };
+
+        // Returns false if the block is corrupted or doesn't decompress to exactly rawSize bytes
+        inline bool decompress(const uint8_t *from, size_t size, uint8_t *to, size_t rawSize) {
+            const uint8_t *in = from, *inEnd = from + size;
+            uint8_t *out = to, *outEnd = to + rawSize;
+
+            while(in < inEnd) {
+                const uint8_t token = *in++;
+
+                size_t literalLength = token >> 4;
+                if(literalLength == 15 && !read_length(in, inEnd, literalLength)) return false;
+                if(literalLength > static_cast<size_t>(inEnd - in) || literalLength > static_cast<size_t>(outEnd - out)) return false;
+
+                memcpy(out, in, literalLength);
+                in += literalLength;
+                out += literalLength;
+                if(in == inEnd) break;
+
+                if(inEnd - in < 2) return false;
+                const size_t offset = in[0] | (size_t(in[1]) << 8);
+                in += 2;
+                if(offset == 0 || offset > static_cast<size_t>(out - to)) return false;
+
+                size_t matchLength = token & 0xF;
+                if(matchLength == 15 && !read_length(in, inEnd, matchLength)) return false;
+                matchLength += kMinMatch;
+                if(matchLength > static_cast<size_t>(outEnd - out)) return false;
+
+                const uint8_t *match = out - offset;
+                if(offset >= matchLength) {
+                    memcpy(out, match, matchLength);
+                    out += matchLength;
+                }
+                else {
+                    // Overlapping matches repeat the last 'offset' bytes
+                    for(size_t i = 0; i < matchLength; i++) *out++ = match[i];
+                }
+            }
+
+            return out == outEnd;
+        }
+    }
+
+    static constexpr size_t kDefaultCompressionBlockSize = 64 * 1024;
+
+    struct compressed_block {
+        const binary_buffer_type *Data;
+        uint32_t StoredSize;
+        uint32_t RawSize;
+        size_t RawOffset;       // Where the block starts in the decompressed data
+
+        bool is_stored() const { return StoredSize == RawSize; }
+
+        bool decompress(binary_buffer_type *to) const {
+            if(is_stored()) {
+                memcpy(to, Data, RawSize);
+                return true;
+            }
+            return lz::decompress(reinterpret_cast<const uint8_t*>(Data), StoredSize, reinterpret_cast<uint8_t*>(to), RawSize);
+        }
+    };
+
+    // Splits compressed data that's already in memory into its blocks, which can then be decompressed independently
+    inline std::vector<compressed_block> find_compressed_blocks(const binary_buffer_type *data, size_t size) {
+        std::vector<compressed_block> blocks;
+        size_t pos = 0, rawOffset = 0;
+        while(pos + 2 * sizeof(uint32_t) <= size) {
+            compressed_block block;
+            memcpy(&block.RawSize, data + pos, sizeof(uint32_t));
+            memcpy(&block.StoredSize, data + pos + sizeof(uint32_t), sizeof(uint32_t));
+            pos += 2 * sizeof(uint32_t);
+            if(block.RawSize == 0 || block.StoredSize > size - pos) break;
+
+            block.Data = data + pos;
+            block.RawOffset = rawOffset;
+            blocks.push_back(block);
+
+            pos += block.StoredSize;
+            rawOffset += block.RawSize;
+        }
+        return blocks;
+    }
+
+    // Stream buffer that compresses everything written to it, block by block, into a sink
+    class compressing_streambuf : public std::streambuf {
+    public:
+        compressing_streambuf(binary_buffer_write& sink, compression_level level = compression_level::fast, size_t blockSize = kDefaultCompressionBlockSize) :
+            m_sink(sink),
+            m_compressor(level),
+            m_block(blockSize),
+            m_compressed(lz::compress_bound(blockSize)) {
+            setp(m_block.data(), m_block.data() + m_block.size());
+        }
+
+        ~compressing_streambuf() override { close(); }
+
+        // Flushes the last block and writes the end of stream marker
+        void close() {
+            if(m_closed) return;
+            flush_block();
+            const uint32_t endMarker[2] = { 0, 0 };
+            m_sink.write(reinterpret_cast<const binary_buffer_type*>(endMarker), sizeof(endMarker));
+            m_sink.flush();
+            m_closed = true;
+        }
+
+    protected:
+        int_type overflow(int_type ch) override {
+            if(m_closed) return traits_type::eof();
+            flush_block();
+            if(!traits_type::eq_int_type(ch, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        int sync() override {
+            flush_block();
+            m_sink.flush();
+            return m_sink ? 0 : -1;
+        }
+
+    private:
+        void flush_block() {
+            const uint32_t rawSize = static_cast<uint32_t>(pptr() - pbase());
+            if(rawSize == 0) return;
+
+            const size_t compressedSize = m_compressor.compress(reinterpret_cast<const uint8_t*>(pbase()), rawSize, m_compressed.data());
+            const bool stored = compressedSize >= rawSize;
+            const uint32_t header[2] = { rawSize, stored ? rawSize : static_cast<uint32_t>(compressedSize) };
+
+            m_sink.write(reinterpret_cast<const binary_buffer_type*>(header), sizeof(header));
+            if(stored) {
+                m_sink.write(pbase(), rawSize);
+            }
+            else {
+                m_sink.write(reinterpret_cast<const binary_buffer_type*>(m_compressed.data()), compressedSize);
+            }
+            setp(m_block.data(), m_block.data() + m_block.size());
+        }
+
+        binary_buffer_write& m_sink;
+        lz::compressor m_compressor;
+        std::vector<binary_buffer_type> m_block;
+        std::vector<uint8_t> m_compressed;
+        bool m_closed = false;
+    };
+
+    // Stream buffer that decompresses blocks from a source as they're read. 'maxBlockSize' has to be at least the
+    // block size the data was written with, bigger blocks are treated as corrupt instead of allocated.
+    class decompressing_streambuf : public std::streambuf {
+    public:
+        explicit decompressing_streambuf(binary_buffer_read& source, size_t maxBlockSize = kDefaultCompressionBlockSize, std::ios *reader = nullptr) :
+            m_source(source), m_maxBlockSize(maxBlockSize), m_reader(reader) {}
+
+        // Only the end of the source or an empty block end the data cleanly, anything else sets badbit
+        // on the source, and on the reader if there's one
+        bool corrupted() const { return m_corrupted; }
+
+    protected:
+        int_type underflow() override {
+            if(gptr() < egptr()) return traits_type::to_int_type(*gptr());
+            if(m_corrupted) return traits_type::eof();
+
+            uint32_t header[2] = { 0, 0 };
+            if(!m_source.read(reinterpret_cast<binary_buffer_type*>(header), sizeof(header))) {
+                return m_source.gcount() == 0 ? traits_type::eof() : corrupt();
+            }
+            if(header[0] == 0) return traits_type::eof();
+
+            const uint32_t rawSize = header[0], storedSize = header[1];
+            if(rawSize > m_maxBlockSize || storedSize > rawSize) return corrupt();
+
+            m_block.resize(rawSize);
+            m_stored.resize(storedSize);
+            if(!m_source.read(reinterpret_cast<binary_buffer_type*>(m_stored.data()), storedSize)) {
+                return corrupt();
+            }
+
+            const compressed_block block { reinterpret_cast<const binary_buffer_type*>(m_stored.data()), storedSize, rawSize, 0 };
+            if(!block.decompress(m_block.data())) {
+                return corrupt();
+            }
+
+            setg(m_block.data(), m_block.data(), m_block.data() + m_block.size());
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        int_type corrupt() {
+            m_corrupted = true;
+            m_source.setstate(std::ios::badbit);
+            if(m_reader) m_reader->setstate(std::ios::badbit);
+            return traits_type::eof();
+        }
+
+        binary_buffer_read& m_source;
+        const size_t m_maxBlockSize;
+        std::ios *m_reader;
+        bool m_corrupted = false;
+        std::vector<binary_buffer_type> m_block;
+        std::vector<uint8_t> m_stored;
+    };
+
+    // Drop-in buffers for serialize/deserialize, e.g:
+    //      mmeta::compressed_buffer_write compressed { file };
+    //      mmeta::serialize(player, compressed);
+    class compressed_buffer_write : public binary_buffer_write {
+    public:
+        compressed_buffer_write(binary_buffer_write& sink, compression_level level = compression_level::fast, size_t blockSize = kDefaultCompressionBlockSize) :
+            binary_buffer_write(nullptr),
+            m_buffer(sink, level, blockSize) {
+            rdbuf(&m_buffer);
+        }
+
+        void close() { m_buffer.close(); }
+
+    private:
+        compressing_streambuf m_buffer;
+    };
+
+    class compressed_buffer_read : public binary_buffer_read {
+    public:
+        explicit compressed_buffer_read(binary_buffer_read& source, size_t maxBlockSize = kDefaultCompressionBlockSize) :
+            binary_buffer_read(nullptr),
+            m_buffer(source, maxBlockSize, this) {
+            rdbuf(&m_buffer);
+        }
+
+    private:
+        decompressing_streambuf m_buffer;
+    };
+}
@@ -1,14 +1,29 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bitset>
 #include <iostream>
 #include <stdint.h>
 #include <type_traits>
 #include <typeinfo>
 #include <cassert>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <utility>
+#include <variant>
 #include <sstream>
+#include <streambuf>
 
 #include <yaml-cpp/yaml.h>
 
@@ -52,6 +67,14 @@ namespace mmeta {
             return hash(str.data());
         }
 
+        // Same as hash, but bounded by the view's size, so it's safe to use with views that aren't null-terminated
+        inline constexpr hash_type hash_bytes(std::string_view str, hash_type value = kFNV1aValue) noexcept {
+            for(const char c : str) {
+                value = (value ^ hash_type(c)) * kFNV1aPrime;
+            }
+            return value;
+        }
+
         template <typename T>
         struct type_name {
           static constexpr std::string_view prettified_name() {
@@ -87,6 +110,67 @@ namespace mmeta {
     using binary_buffer_write = std::ostream;
     using binary_buffer_read = std::istream;
 
+    // Write buffer backed by a vector, which keeps its capacity when cleared so it can be reused
+    class memory_buffer_write : public binary_buffer_write {
+    public:
+        memory_buffer_write() : binary_buffer_write(nullptr) { rdbuf(&m_buffer); }
+
+        const binary_buffer_type* data() const { return m_buffer.Data.data(); }
+        binary_buffer_type* data() { return m_buffer.Data.data(); }
+        size_t size() const { return m_buffer.Data.size(); }
+        void clear() { m_buffer.Data.clear(); binary_buffer_write::clear(); }
+
+    private:
+        struct vector_streambuf : public std::streambuf {
+            std::vector<binary_buffer_type> Data;
+
+            std::streamsize xsputn(const char_type* s, std::streamsize count) override {
+                Data.insert(Data.end(), s, s + count);
+                return count;
+            }
+
+            int_type overflow(int_type ch) override {
+                if(!traits_type::eq_int_type(ch, traits_type::eof())) {
+                    Data.push_back(traits_type::to_char_type(ch));
+                }
+                return traits_type::not_eof(ch);
+            }
+        };
+
+        vector_streambuf m_buffer;
+    };
+
+    // Read buffer over memory owned by someone else, nothing is copied
+    class memory_buffer_read : public binary_buffer_read {
+    public:
+        memory_buffer_read(const binary_buffer_type* data, size_t size) : binary_buffer_read(nullptr) {
+            binary_buffer_type* begin = const_cast<binary_buffer_type*>(data);
+            m_buffer.reset(begin, begin + size);
+            rdbuf(&m_buffer);
+        }
+
+        // Lets readers keep views into the buffer instead of copying out of it
+        const binary_buffer_type* position() const { return m_buffer.position(); }
+        size_t remaining() const { return m_buffer.remaining(); }
+
+        void skip(size_t size) { m_buffer.advance(size); }
+
+    private:
+        struct view_streambuf : public std::streambuf {
+            void reset(char_type* begin, char_type* end) { setg(begin, begin, end); }
+
+            const char_type* position() const { return gptr(); }
+            size_t remaining() const { return static_cast<size_t>(egptr() - gptr()); }
+
+            void advance(size_t size) {
+                assert(size <= remaining() && "Skipping past the end of the buffer.");
+                setg(eback(), gptr() + size, egptr());
+            }
+        };
+
+        view_streambuf m_buffer;
+    };
+
     using yaml_node = YAML::Node;
 
     using meta_type = int;
@@ -95,20 +179,60 @@ namespace mmeta {
     class basic_mmfield;
     using mmfield = basic_mmfield<meta_type>;
 
+    class column_sink;
+    class column_source;
+    class incremental_decoder;
+    class validating_reader;
+    struct optional_actions;
+
     struct basic_type_actions {
         using ReadFn = void (*)(const mmfield*, binary_buffer_read&, void *);
         using WriteFn = void (*)(const mmfield*, const void *, binary_buffer_write&);
 
         using ReadYAMLFn = void (*)(const mmfield*, const yaml_node&, void *);
         using WriteYAMLFn = void (*)(const mmfield*, const void*, yaml_node&);
+        using ApplyYAMLFn = bool (*)(const mmfield*, const yaml_node&, void *);
+
+        using ReadColumnFn = void (*)(const mmfield*, column_source&, void * const *, size_t);
+        using WriteColumnFn = void (*)(const mmfield*, const std::string&, const void * const *, size_t, column_sink&);
 
-        constexpr basic_type_actions(const ReadFn readFn, const WriteFn writeFn, const ReadYAMLFn readYamlFn, const WriteYAMLFn writeYamlFn) :
-            Read(readFn), Write(writeFn), ReadYAML(readYamlFn), WriteYAML(writeYamlFn) {}
+        using PushDecodeFn = void (*)(incremental_decoder&, void *);
+        using SizeFn = size_t (*)(const mmfield*, const void *);
+        using ValidatedReadFn = bool (*)(const mmfield*, validating_reader&, void *);
+
+        using WriteEvolvableFn = void (*)(const mmfield*, const void *, memory_buffer_write&);
+        using ReadEvolvableFn = bool (*)(const mmfield*, validating_reader&, void *);
+
+        using EqualFn = bool (*)(const mmfield*, const void *, const void *);
+        using HashFn = size_t (*)(const mmfield*, const void *, size_t);
+        using CopyFn = void (*)(const mmfield*, const void *, void *);
+
+        constexpr basic_type_actions(const ReadFn readFn, const WriteFn writeFn, const ReadYAMLFn readYamlFn, const WriteYAMLFn writeYamlFn,
+                                     const ApplyYAMLFn applyYamlFn, const ReadColumnFn readColumnFn, const WriteColumnFn writeColumnFn, const PushDecodeFn pushDecodeFn,
+                                     const SizeFn sizeFn, const ValidatedReadFn validatedReadFn, const WriteEvolvableFn writeEvolvableFn,
+                                     const ReadEvolvableFn readEvolvableFn, const EqualFn equalFn, const HashFn hashFn, const CopyFn copyFn,
+                                     const optional_actions *optional, bool isOptional) :
+            Read(readFn), Write(writeFn), ReadYAML(readYamlFn), WriteYAML(writeYamlFn), ApplyYAML(applyYamlFn), ReadColumn(readColumnFn), WriteColumn(writeColumnFn),
+            PushDecode(pushDecodeFn), Size(sizeFn), ValidatedRead(validatedReadFn), WriteEvolvable(writeEvolvableFn), ReadEvolvable(readEvolvableFn),
+            Equal(equalFn), Hash(hashFn), Copy(copyFn), Optional(optional), IsOptional(isOptional) {}
 
         const ReadFn Read;
         const WriteFn Write;
         const ReadYAMLFn ReadYAML;
         const WriteYAMLFn WriteYAML;
+        const ApplyYAMLFn ApplyYAML;
+        const ReadColumnFn ReadColumn;
+        const WriteColumnFn WriteColumn;
+        const PushDecodeFn PushDecode;
+        const SizeFn Size;
+        const ValidatedReadFn ValidatedRead;
+        const WriteEvolvableFn WriteEvolvable;
+        const ReadEvolvableFn ReadEvolvable;
+        const EqualFn Equal;
+        const HashFn Hash;
+        const CopyFn Copy;
+        const optional_actions *Optional;      // Only set for std::optional
+        const bool IsOptional;                  // Same as Optional != nullptr, but usable in constant expressions
 
         template <typename T>
         static constexpr basic_type_actions instantiate();
@@ -147,6 +271,15 @@ namespace mmeta {
     };
     using mmtype = basic_mmtype<meta_type>;
 
+    // Lets classes keep the presence of their optional fields in packed bits, while the value
+    // itself is handled by the contained type
+    struct optional_actions {
+        const void *(*Find)(const void *);      // Contained value, or nullptr if empty
+        void *(*Emplace)(void *);
+        void (*Reset)(void *);
+        const mmtype *ValueType;
+    };
+
     template <typename Meta>
     class basic_mmfield {
     public:
@@ -155,6 +288,7 @@ namespace mmeta {
         inline constexpr basic_mmtype<Meta> type() const { return m_type; }
         inline constexpr std::string_view name() const { return m_name; }
         inline constexpr uint64_t hash() const { return m_type.hash(); }
+        inline constexpr size_t offset() const { return m_offset; }
 
         const void * get_pointer_from(const void * src) const {
             return static_cast<const binary_buffer_type*>(src) + m_offset;
@@ -164,6 +298,23 @@ namespace mmeta {
             return static_cast<binary_buffer_type*>(src) + m_offset;
         }
 
+        template <typename T>
+        T& get(void * src) const {
+            assert(utils::hash(utils::type_name<T>::name) == m_type.hash() && ">> ERROR: Trying to get field using wrong type.");
+            return *static_cast<T*>(get_pointer_from(src));
+        }
+
+        template <typename T>
+        const T& get(void const * src) const {
+            assert(utils::hash(utils::type_name<T>::name) == m_type.hash() && ">> ERROR: Trying to get field using wrong type.");
+            return *static_cast<const T*>(get_pointer_from(src));
+        }
+
+        template <typename T>
+        void set(void * dst, const T& value) const {
+            get<T>(dst) = value;
+        }
+
         template <typename T>
         T get_as(void const * src) const {
             //assert(typemeta_v<meta_type, T>.hash() == m_type.hash() && ">> ERROR: Trying to get field using wrong type.");
@@ -192,16 +343,72 @@ namespace mmeta {
     };
     using fieldseq = basic_fieldseq<meta_type>;
 
+    inline constexpr size_t invalid_field_index = static_cast<size_t>(-1);
+
+    // Perfect hash over the names of a class' fields, so they can be found in O(1).
+    // Names are split into buckets of about 4 and each bucket has a displacement that moves its names into
+    // free slots (hash and displace). Slots store field index + 1, so 0 means the slot is empty.
+    // Without slots (Bits == 0) the names have to be compared one by one.
+    struct fieldlookup {
+        const uint16_t *Slots;
+        const uint16_t *Displacements;
+        uint32_t Bits;
+        uint32_t BucketBits;
+
+        constexpr fieldlookup(const uint16_t *slots, const uint16_t *displacements, uint32_t bits, uint32_t bucketBits) :
+            Slots(slots), Displacements(displacements), Bits(bits), BucketBits(bucketBits) {}
+
+        static constexpr hash_type mix(hash_type value) {
+            value = (value ^ (value >> 33)) * 0xFF51AFD7ED558CCDull;
+            value = (value ^ (value >> 33)) * 0xC4CEB9FE1A85EC53ull;
+            return value ^ (value >> 33);
+        }
+
+        static constexpr size_t bucket_of(hash_type nameHash, uint32_t bucketBits) {
+            return static_cast<size_t>(mix(nameHash) >> (64 - bucketBits));
+        }
+
+        static constexpr size_t slot_of(hash_type nameHash, uint16_t displacement, uint32_t bits) {
+            return static_cast<size_t>(mix(nameHash ^ ((displacement + 1ull) * 0x9E3779B97F4A7C15ull)) >> (64 - bits));
+        }
+
+        // Returns the candidate field index, the caller still has to compare names
+        constexpr size_t candidate(std::string_view name) const {
+            const hash_type nameHash = utils::hash_bytes(name);
+            return static_cast<size_t>(Slots[slot_of(nameHash, Displacements[bucket_of(nameHash, BucketBits)], Bits)]) - 1;
+        }
+    };
+
     template <typename Meta>
     class basic_mmclass {
     public:
-        constexpr basic_mmclass<Meta>(basic_fieldseq<Meta> fields, hash_type version) : m_fields(fields), m_version(version) {}
+        constexpr basic_mmclass<Meta>(basic_fieldseq<Meta> fields, hash_type version, fieldlookup lookup) : m_fields(fields), m_version(version), m_lookup(lookup) {}
 
         constexpr size_t field_count() const { return m_fields.size(); }
 
         constexpr basic_fieldseq<Meta> fields() const { return m_fields; }
 
         constexpr hash_type version() const { return m_version; }
+
+        constexpr size_t find_field_index(std::string_view name) const {
+            if(m_lookup.Bits == 0) {
+                for(size_t i = 0; i < field_count(); i++) {
+                    if(m_fields.Ptr[i].name() == name) return i;
+                }
+                return invalid_field_index;
+            }
+
+            const size_t index = m_lookup.candidate(name);
+            if(index < field_count() && m_fields.Ptr[index].name() == name) {
+                return index;
+            }
+            return invalid_field_index;
+        }
+
+        constexpr const basic_mmfield<Meta>* find_field(std::string_view name) const {
+            const size_t index = find_field_index(name);
+            return index != invalid_field_index ? &m_fields.Ptr[index] : nullptr;
+        }
         
         void dump() const {
             std::cout  << "class: num_fields => " << field_count() << "\n";
@@ -209,6 +416,7 @@ namespace mmeta {
     private:
         const basic_fieldseq<Meta> m_fields;
         const hash_type m_version;
+        const fieldlookup m_lookup;
     };
     using mmclass = basic_mmclass<meta_type>;
 
@@ -252,9 +460,121 @@ namespace mmeta {
         utils::type_name<T>::name,
         basic_mmtype<Meta>::action_type::template instantiate<T>()};
 
+    // Room for 4 slots per field, lookups start out with half of them
+    constexpr uint32_t field_lookup_bits(size_t fieldCount) {
+        uint32_t bits = 2;
+        while((size_t(1) << bits) < fieldCount * 4) bits++;
+        return bits;
+    }
+
+    // About 4 fields per bucket
+    constexpr uint32_t field_bucket_bits(size_t fieldCount) {
+        uint32_t bits = 1;
+        while((size_t(1) << bits) * 4 < fieldCount) bits++;
+        return bits;
+    }
+
+    // Displacements a bucket tries before the lookup gives up on its current number of slots
+    inline constexpr uint16_t kFieldLookupDisplacements = 1024;
+
+    template <size_t FieldCount>
+    struct field_lookup_table {
+        static constexpr uint32_t max_bits = field_lookup_bits(FieldCount);
+        static constexpr uint32_t bucket_bits = field_bucket_bits(FieldCount);
+        static constexpr size_t bucket_count = size_t(1) << bucket_bits;
+
+        uint32_t Bits = 0;
+        uint16_t Slots[size_t(1) << max_bits] = {};
+        uint16_t Displacements[bucket_count] = {};
+    };
+
+    // Places every bucket, largest first, at the first displacement that moves all of its names to free slots.
+    // 'members' holds field indices grouped by bucket, bucket b owns [starts[b], starts[b + 1]).
+    template <typename Table>
+    constexpr bool place_field_buckets(Table& table, uint32_t bits, const hash_type *nameHashes, const size_t *members,
+                                       const size_t *starts, size_t largest) {
+        for(auto& slot : table.Slots) slot = 0;
+
+        for(size_t size = largest; size > 0; size--) {
+            for(size_t bucket = 0; bucket < Table::bucket_count; bucket++) {
+                const size_t first = starts[bucket], last = starts[bucket + 1];
+                if(last - first != size) continue;
+
+                bool placed = false;
+                for(uint16_t displacement = 0; !placed && displacement < kFieldLookupDisplacements; displacement++) {
+                    size_t next = first;
+                    for(; next < last; next++) {
+                        const size_t slot = fieldlookup::slot_of(nameHashes[members[next]], displacement, bits);
+                        if(table.Slots[slot] != 0) break;
+                        table.Slots[slot] = static_cast<uint16_t>(members[next] + 1);
+                    }
+
+                    placed = next == last;
+                    for(size_t i = first; !placed && i < next; i++) {
+                        table.Slots[fieldlookup::slot_of(nameHashes[members[i]], displacement, bits)] = 0;
+                    }
+                    if(placed) table.Displacements[bucket] = displacement;
+                }
+                if(!placed) return false;
+            }
+        }
+        return true;
+    }
+
+    // Builds the lookup at compile-time. With twice as many slots as names, each displacement a bucket of k names
+    // tries works with a probability above 2^-k, so the whole build is expected to be linear in the field count.
+    // If a bucket runs out of displacements the slots are doubled once, and if that fails too (two names with the
+    // same 64-bit hash) the class falls back to comparing names. Either way the build stays within
+    // 2 * kFieldLookupDisplacements tries per field.
+    template <typename T>
+    constexpr auto make_field_lookup() {
+        constexpr size_t count = mmclass_storage<T>::field_count();
+        using table_type = field_lookup_table<count>;
+
+        hash_type nameHashes[count] = {};
+        size_t buckets[count] = {};
+        size_t starts[table_type::bucket_count + 1] = {};
+        for(size_t i = 0; i < count; i++) {
+            nameHashes[i] = utils::hash_bytes(mmclass_storage<T>::Fields[i].name());
+            buckets[i] = fieldlookup::bucket_of(nameHashes[i], table_type::bucket_bits);
+            starts[buckets[i] + 1]++;
+        }
+
+        size_t largest = 0;
+        for(size_t b = 0; b < table_type::bucket_count; b++) {
+            largest = starts[b + 1] > largest ? starts[b + 1] : largest;
+            starts[b + 1] += starts[b];
+        }
+
+        size_t members[count] = {};
+        size_t filled[table_type::bucket_count] = {};
+        for(size_t i = 0; i < count; i++) {
+            members[starts[buckets[i]] + filled[buckets[i]]++] = i;
+        }
+
+        table_type table{};
+        for(uint32_t bits = table_type::max_bits - 1; bits <= table_type::max_bits; bits++) {
+            if(place_field_buckets(table, bits, nameHashes, members, starts, largest)) {
+                table.Bits = bits;
+                return table;
+            }
+        }
+        for(auto& displacement : table.Displacements) displacement = 0;
+        return table;
+    }
+
+    template <typename T>
+    inline constexpr auto field_lookup_v = make_field_lookup<T>();
+
     template<typename T>
     inline constexpr class_type<T> classmeta_v = {
-        mmclass_storage<T>::fields(), mmclass_storage<T>::version()};
+        mmclass_storage<T>::fields(), mmclass_storage<T>::version(),
+        { field_lookup_v<T>.Slots, field_lookup_v<T>.Displacements, field_lookup_v<T>.Bits, field_lookup_v<T>.bucket_bits }};
+
+    template <typename T>
+    constexpr size_t field_index(std::string_view name) {
+        return classmeta_v<T>.find_field_index(name);
+    }
 
     template<class T>
     struct is_vector : std::false_type {};
@@ -268,6 +588,123 @@ namespace mmeta {
     template<typename T>
     inline constexpr bool is_string_v = std::is_same_v<T, std::string>;
 
+    // C arrays and std::array, the element count is part of the type
+    template <typename T>
+    struct is_fixed_array : std::false_type {};
+
+    template <typename T, size_t N>
+    struct is_fixed_array<T[N]> : std::true_type {
+        using value_type = T;
+        static constexpr size_t size = N;
+    };
+
+    template <typename T, size_t N>
+    struct is_fixed_array<std::array<T, N>> : std::true_type {
+        using value_type = T;
+        static constexpr size_t size = N;
+    };
+
+    template <typename T>
+    inline constexpr bool is_fixed_array_v = is_fixed_array<T>::value;
+
+    // std::map, std::set and their multi/unordered variants
+    template <typename T>
+    struct is_associative : std::false_type {};
+
+    template <typename K, typename... Rest>
+    struct is_associative<std::set<K, Rest...>> : std::true_type {};
+
+    template <typename K, typename... Rest>
+    struct is_associative<std::multiset<K, Rest...>> : std::true_type {};
+
+    template <typename K, typename... Rest>
+    struct is_associative<std::unordered_set<K, Rest...>> : std::true_type {};
+
+    template <typename K, typename... Rest>
+    struct is_associative<std::unordered_multiset<K, Rest...>> : std::true_type {};
+
+    template <typename K, typename V, typename... Rest>
+    struct is_associative<std::map<K, V, Rest...>> : std::true_type {};
+
+    template <typename K, typename V, typename... Rest>
+    struct is_associative<std::multimap<K, V, Rest...>> : std::true_type {};
+
+    template <typename K, typename V, typename... Rest>
+    struct is_associative<std::unordered_map<K, V, Rest...>> : std::true_type {};
+
+    template <typename K, typename V, typename... Rest>
+    struct is_associative<std::unordered_multimap<K, V, Rest...>> : std::true_type {};
+
+    template <typename T>
+    inline constexpr bool is_associative_v = is_associative<T>::value;
+
+    template <typename T, class = void>
+    struct is_map_like : std::false_type {};
+
+    template <typename T>
+    struct is_map_like<T, std::void_t<typename T::mapped_type>> : std::true_type {};
+
+    template <typename T>
+    inline constexpr bool is_map_like_v = is_map_like<T>::value;
+
+    template <typename T>
+    struct is_optional : std::false_type {};
+
+    template <typename T>
+    struct is_optional<std::optional<T>> : std::true_type {};
+
+    template <typename T>
+    inline constexpr bool is_optional_v = is_optional<T>::value;
+
+    template <typename T>
+    struct is_variant : std::false_type {};
+
+    template <typename... Ts>
+    struct is_variant<std::variant<Ts...>> : std::true_type {};
+
+    template <typename T>
+    inline constexpr bool is_variant_v = is_variant<T>::value;
+
+    // Index of the active alternative on the wire, the value after the last alternative means valueless
+    template <typename V>
+    using variant_tag_t = std::conditional_t<(std::variant_size_v<V> < 255), uint8_t, uint32_t>;
+
+    template <typename A, class = void>
+    struct is_unordered : std::false_type {};
+
+    template <typename A>
+    struct is_unordered<A, std::void_t<typename A::hasher>> : std::true_type {};
+
+    template <typename T, class = void>
+    struct has_reserve : std::false_type {};
+
+    template <typename T>
+    struct has_reserve<T, std::void_t<decltype(std::declval<T&>().reserve(size_t(0)))>> : std::true_type {};
+
+    template <typename A>
+    const typename A::key_type& entry_key(const typename A::value_type& entry) {
+        if constexpr (is_map_like_v<A>) return entry.first;
+        else return entry;
+    }
+
+    // Unordered containers get their buckets up front, so decoding never rehashes
+    template <typename A>
+    void reserve_entries(A& container, size_t count) {
+        if constexpr (has_reserve<A>::value) container.reserve(count);
+    }
+
+    // Entries are written in iteration order, so hinting at the end makes ordered inserts O(1).
+    // Mapped values are default constructed in the node and decoded in place afterwards.
+    template <typename A>
+    typename A::iterator emplace_entry(A& container, typename A::key_type&& key) {
+        if constexpr (is_map_like_v<A>) {
+            return container.emplace_hint(container.end(), std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple());
+        }
+        else {
+            return container.emplace_hint(container.end(), std::move(key));
+        }
+    }
+
     template <typename, class = void>
     struct is_defined : std::false_type {};
     
@@ -301,11 +738,137 @@ namespace mmeta {
     struct is_serializable<std::string> {
         static constexpr bool value = true;
     };
+
+    template <typename T, size_t N>
+    struct is_serializable<T[N]> {
+        static constexpr bool value = is_serializable<T>::value;
+    };
+
+    template <typename T, size_t N>
+    struct is_serializable<std::array<T, N>> {
+        static constexpr bool value = is_serializable<T>::value;
+    };
+
+    template <typename K, typename... Rest>
+    struct is_serializable<std::set<K, Rest...>> : is_serializable<K> {};
+
+    template <typename K, typename... Rest>
+    struct is_serializable<std::multiset<K, Rest...>> : is_serializable<K> {};
+
+    template <typename K, typename... Rest>
+    struct is_serializable<std::unordered_set<K, Rest...>> : is_serializable<K> {};
+
+    template <typename K, typename... Rest>
+    struct is_serializable<std::unordered_multiset<K, Rest...>> : is_serializable<K> {};
+
+    template <typename K, typename V>
+    struct is_serializable_entry {
+        static constexpr bool value = is_serializable<K>::value && is_serializable<V>::value;
+    };
+
+    template <typename K, typename V, typename... Rest>
+    struct is_serializable<std::map<K, V, Rest...>> : is_serializable_entry<K, V> {};
+
+    template <typename K, typename V, typename... Rest>
+    struct is_serializable<std::multimap<K, V, Rest...>> : is_serializable_entry<K, V> {};
+
+    template <typename K, typename V, typename... Rest>
+    struct is_serializable<std::unordered_map<K, V, Rest...>> : is_serializable_entry<K, V> {};
+
+    template <typename K, typename V, typename... Rest>
+    struct is_serializable<std::unordered_multimap<K, V, Rest...>> : is_serializable_entry<K, V> {};
+
+    template <typename T>
+    struct is_serializable<std::optional<T>> : is_serializable<T> {};
+
+    // std::monostate has nothing to serialize, so it's allowed as an empty alternative
+    template <typename... Ts>
+    struct is_serializable<std::variant<Ts...>> {
+        static constexpr bool value = ((is_serializable<Ts>::value || std::is_same_v<Ts, std::monostate>) && ...);
+    };
 #endif
 
     template<typename T>
     inline constexpr bool is_serializable_v = is_serializable<T>::value;
 
+    template <typename O>
+    const void *find_optional_value(const void *from) {
+        const O* value = static_cast<const O*>(from);
+        return value->has_value() ? &**value : nullptr;
+    }
+
+    template <typename O>
+    void *emplace_optional_value(void *to) { return &static_cast<O*>(to)->emplace(); }
+
+    template <typename O>
+    void reset_optional(void *to) { static_cast<O*>(to)->reset(); }
+
+    template <typename T>
+    inline constexpr optional_actions optional_actions_storage = {
+        &find_optional_value<std::optional<T>>, &emplace_optional_value<std::optional<T>>, &reset_optional<std::optional<T>>, &typemeta_v<T>
+    };
+
+    template <typename T>
+    inline constexpr bool has_optional_actions_v = false;
+
+    template <typename T>
+    inline constexpr bool has_optional_actions_v<std::optional<T>> = is_serializable_v<T>;
+
+    template <typename T>
+    inline constexpr const optional_actions *optional_actions_v = nullptr;
+
+    template <typename T>
+    inline constexpr const optional_actions *optional_actions_v<std::optional<T>> = has_optional_actions_v<std::optional<T>> ? &optional_actions_storage<T> : nullptr;
+
+    template <typename V, size_t I>
+    const void *get_variant_alternative(const void *from) { return std::get_if<I>(static_cast<const V*>(from)); }
+
+    template <typename V, size_t I>
+    void *emplace_variant_alternative(void *to) { return &static_cast<V*>(to)->template emplace<I>(); }
+
+    // Jump table over the alternatives of a variant, indexed by the wire tag
+    template <typename V, typename = std::make_index_sequence<std::variant_size_v<V>>>
+    struct variant_table;
+
+    template <typename V, size_t... I>
+    struct variant_table<V, std::index_sequence<I...>> {
+        using get_fn = const void *(*)(const void *);
+        using emplace_fn = void *(*)(void *);
+
+        static constexpr size_t count = sizeof...(I);
+        static constexpr const mmtype *types[] = { &typemeta_v<std::variant_alternative_t<I, V>>... };
+        static constexpr get_fn getters[] = { &get_variant_alternative<V, I>... };
+        static constexpr emplace_fn emplacers[] = { &emplace_variant_alternative<V, I>... };
+
+        static variant_tag_t<V> tag_of(const V& value) {
+            return static_cast<variant_tag_t<V>>(value.valueless_by_exception() ? count : value.index());
+        }
+    };
+
+    template <typename T>
+    constexpr bool contains_class();
+
+    template <typename V, size_t... I>
+    constexpr bool any_alternative_contains_class(std::index_sequence<I...>) {
+        return (contains_class<std::variant_alternative_t<I, V>>() || ...);
+    }
+
+    // Whether a reflected class appears anywhere inside T
+    template <typename T>
+    constexpr bool contains_class() {
+        if constexpr (is_fixed_array_v<T>) return contains_class<typename is_fixed_array<T>::value_type>();
+        else if constexpr (is_vector_v<T> || is_optional_v<T>) return contains_class<typename T::value_type>();
+        else if constexpr (is_associative_v<T>) {
+            if constexpr (is_map_like_v<T>) return contains_class<typename T::key_type>() || contains_class<typename T::mapped_type>();
+            else return contains_class<typename T::key_type>();
+        }
+        else if constexpr (is_variant_v<T>) return any_alternative_contains_class<T>(std::make_index_sequence<std::variant_size_v<T>>());
+        else return is_hashed_type_v<T>;
+    }
+
+    template <typename T>
+    inline constexpr bool contains_class_v = contains_class<T>();
+
     // ========================================================================-------
     // ======= Class Storage Utils
     // ========================================================================-------
@@ -339,6 +902,205 @@ namespace mmeta {
         );
     }
 
+    template <typename C>
+    constexpr size_t optional_field_count() {
+        size_t count = 0;
+        for(const mmfield& field : mmclass_storage<C>::Fields) {
+            if(field.type().actions().IsOptional) count++;
+        }
+        return count;
+    }
+
+    template <typename C>
+    constexpr size_t presence_size() { return (optional_field_count<C>() + 7) / 8; }
+
+    // One bit per optional field of C, in field order, set when it holds a value
+    template <typename C>
+    using presence_bits = std::array<uint8_t, presence_size<C>()>;
+
+    inline bool has_presence(const uint8_t *bits, size_t index) { return (bits[index / 8] >> (index % 8)) & 1; }
+
+    template <typename C>
+    presence_bits<C> make_presence_bits(const void *from) {
+        presence_bits<C> bits{};
+        size_t optionalIndex = 0;
+        for_each_field<C>([&](const mmfield& field) {
+            if(const optional_actions* optional = field.type().actions().Optional) {
+                if(optional->Find(field.get_pointer_from(from))) bits[optionalIndex / 8] |= uint8_t(1) << (optionalIndex % 8);
+                optionalIndex++;
+            }
+        });
+        return bits;
+    }
+
+    // Reflected class of the I-th field of T, or hashed_type<...>::notype if the field isn't a reflected class
+    template <typename T, size_t I>
+    using reflected_field_t = hashed_type_t<mmclass_storage<T>::Fields[I].hash()>;
+
+    template <typename... Ts>
+    constexpr bool matches_any_hash(hash_type hash) {
+        return ((utils::hash(utils::type_name<Ts>::name) == hash) || ...);
+    }
+
+    constexpr bool is_fundamental_hash(hash_type hash) {
+        return matches_any_hash<bool, char, signed char, unsigned char, wchar_t, char16_t, char32_t,
+                                short, unsigned short, int, unsigned int, long, unsigned long,
+                                long long, unsigned long long, float, double, long double>(hash);
+    }
+
+    // ========================================================================-------
+    // ======= Interning
+    // ========================================================================-------
+
+    inline void write_varint(uint64_t value, binary_buffer_write& to) {
+        binary_buffer_type bytes[10];
+        size_t count = 0;
+        for(; value >= 0x80; value >>= 7) {
+            bytes[count++] = static_cast<binary_buffer_type>((value & 0x7F) | 0x80);
+        }
+        bytes[count++] = static_cast<binary_buffer_type>(value);
+        to.write(bytes, count);
+    }
+
+    inline uint64_t read_varint(binary_buffer_read& from) {
+        uint64_t value = 0;
+        for(uint32_t shift = 0; shift < 64; shift += 7) {
+            const auto byte = from.get();
+            if(byte == binary_buffer_read::traits_type::eof()) break;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if(!(byte & 0x80)) return value;
+        }
+        from.setstate(std::ios::failbit);
+        return 0;
+    }
+
+    // Per-stream slot the interning tables attach to
+    inline int intern_slot() {
+        static const int slot = std::ios_base::xalloc();
+        return slot;
+    }
+
+    // While attached to a stream, strings and vectors of fundamentals written to it go through a table:
+    // the first copy is written in full and gets the next index, repeats are written as that index.
+    // Blob: [varint index + 1], or [0][varint byte size][bytes] for the first copy.
+    // The stream has to be read back with a binary_intern_reader attached.
+    class binary_interner {
+    public:
+        explicit binary_interner(binary_buffer_write& stream) : m_stream(stream) {
+            assert(!m_stream.pword(intern_slot()) && "The stream already has an interner attached.");
+            m_stream.pword(intern_slot()) = this;
+        }
+
+        ~binary_interner() { m_stream.pword(intern_slot()) = nullptr; }
+
+        binary_interner(const binary_interner&) = delete;
+        binary_interner& operator=(const binary_interner&) = delete;
+
+        static binary_interner* attached_to(binary_buffer_write& stream) {
+            return static_cast<binary_interner*>(stream.pword(intern_slot()));
+        }
+
+        void write(const void *data, size_t size, binary_buffer_write& to) {
+            const std::string_view bytes { static_cast<const char*>(data), size };
+            if(const auto it = m_indices.find(bytes); it != m_indices.end()) {
+                write_varint(it->second + 1, to);
+                m_repeats++;
+                return;
+            }
+
+            write_varint(0, to);
+            write_varint(size, to);
+            to.write(reinterpret_cast<const binary_buffer_type*>(data), size);
+            if(size > 0) {
+                // Keys point into our own copies, the serialized values don't have to outlive the table
+                const std::string& stored = m_storage.emplace_back(bytes);
+                m_indices.emplace(stored, static_cast<uint64_t>(m_indices.size()));
+            }
+        }
+
+        size_t unique_count() const { return m_indices.size(); }
+        size_t repeat_count() const { return m_repeats; }
+
+    private:
+        binary_buffer_write& m_stream;
+        std::deque<std::string> m_storage;
+        std::unordered_map<std::string_view, uint64_t> m_indices;
+        size_t m_repeats = 0;
+    };
+
+    // Reading side of binary_interner. When attached to a memory_buffer_read, blobs are views into its
+    // buffer and nothing is copied into the table, otherwise the reader keeps its own copies.
+    // Either way, blob() views stay valid for as long as the reader (and the buffer) live.
+    class binary_intern_reader {
+    public:
+        explicit binary_intern_reader(binary_buffer_read& stream) :
+            m_stream(stream),
+            m_memory(dynamic_cast<memory_buffer_read*>(&stream)) {
+            assert(!m_stream.pword(intern_slot()) && "The stream already has an intern reader attached.");
+            m_stream.pword(intern_slot()) = this;
+        }
+
+        ~binary_intern_reader() { m_stream.pword(intern_slot()) = nullptr; }
+
+        binary_intern_reader(const binary_intern_reader&) = delete;
+        binary_intern_reader& operator=(const binary_intern_reader&) = delete;
+
+        static binary_intern_reader* attached_to(binary_buffer_read& stream) {
+            return static_cast<binary_intern_reader*>(stream.pword(intern_slot()));
+        }
+
+        // Reads the next blob reference, an empty view is returned on error with the failbit set
+        std::string_view read(binary_buffer_read& from) {
+            const uint64_t reference = read_varint(from);
+            if(reference > m_blobs.size()) {
+                from.setstate(std::ios::failbit);
+                return {};
+            }
+            if(reference > 0) return m_blobs[reference - 1];
+
+            const uint64_t size = read_varint(from);
+            if(size == 0) return {};
+
+            // The size isn't trusted: memory buffers know what's left, other streams are read in bounded
+            // steps so a bogus size runs out of input before it's allocated
+            std::string_view blob;
+            if(m_memory == &from) {
+                if(size > m_memory->remaining()) {
+                    from.setstate(std::ios::failbit);
+                    return {};
+                }
+                blob = { m_memory->position(), static_cast<size_t>(size) };
+                m_memory->skip(blob.size());
+            }
+            else {
+                std::string& stored = m_storage.emplace_back();
+                while(stored.size() < size) {
+                    const size_t filled = stored.size();
+                    const size_t step = std::min<uint64_t>(size - filled, kReadStep);
+                    stored.resize(filled + step);
+                    if(!from.read(stored.data() + filled, static_cast<std::streamsize>(step))) {
+                        m_storage.pop_back();
+                        return {};
+                    }
+                }
+                blob = stored;
+            }
+            m_blobs.push_back(blob);
+            return blob;
+        }
+
+        std::string_view blob(size_t index) const { return m_blobs[index]; }
+        size_t blob_count() const { return m_blobs.size(); }
+
+    private:
+        static constexpr size_t kReadStep = size_t(64) << 10;
+
+        binary_buffer_read& m_stream;
+        memory_buffer_read *m_memory;
+        std::deque<std::string> m_storage;
+        std::vector<std::string_view> m_blobs;
+    };
+
     // ========================================================================-------
     // ======= Binary Serialization
     // ========================================================================-------
@@ -377,8 +1139,20 @@ namespace mmeta {
         static constexpr hash_type version = classmeta_v<C>.version();
         write<hash_type>(container, &version, to);
 
+        if constexpr (presence_size<C>() > 0) {
+            const presence_bits<C> presence = make_presence_bits<C>(from);
+            to.write(reinterpret_cast<const binary_buffer_type*>(presence.data()), presence.size());
+        }
+
         for_each_field<C>([&](const mmfield& field) {
-            field.type().actions().Write(&field, field.get_pointer_from(from), to);
+            const void *fieldValue = field.get_pointer_from(from);
+            if(const optional_actions* optional = field.type().actions().Optional) {
+                // Presence is already in the class' bits, so only the value is written
+                if(const void *value = optional->Find(fieldValue)) optional->ValueType->actions().Write(&field, value, to);
+            }
+            else {
+                field.type().actions().Write(&field, fieldValue, to);
+            }
         });
     }
 
@@ -391,26 +1165,225 @@ namespace mmeta {
 
         const D* value = static_cast<const D*>(from);
         arr_size_type elementCount = value->size();
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            if(binary_interner* interner = binary_interner::attached_to(to)) {
+                interner->write(value->data(), elementCount * sizeof(arr_value_type), to);
+                return;
+            }
+        }
+
         write<arr_size_type>(container, &elementCount, to);
-        for(size_t i = 0; i < elementCount; i++) {
-            write<arr_value_type>(container, (value->data() + i), to);
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            // Contiguous primitives go out as a single block
+            to.write(reinterpret_cast<const binary_buffer_type*>(value->data()), elementCount * sizeof(arr_value_type));
+        }
+        else {
+            for(size_t i = 0; i < elementCount; i++) {
+                write<arr_value_type>(container, (value->data() + i), to);
+            }
         }
     }
 
-    template <typename T, typename Meta = meta_type>
-    std::enable_if_t<is_serializable_v<T>, T>
-    deserialize(binary_buffer_read& buffer) {
-        T inst;
-        read<T>(nullptr, buffer, (void*) &inst);
-        return inst;
+    // Serializes fixed-size arrays, the count comes from the type so there's no size prefix
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>>
+    write_serializable(const mmfield* container, const void *from, binary_buffer_write& to) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+        constexpr size_t elementCount = is_fixed_array<A>::size;
+
+        const arr_value_type* elements = std::data(*static_cast<const A*>(from));
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            to.write(reinterpret_cast<const binary_buffer_type*>(elements), elementCount * sizeof(arr_value_type));
+        }
+        else {
+            for(size_t i = 0; i < elementCount; i++) {
+                write<arr_value_type>(container, elements + i, to);
+            }
+        }
     }
 
-    template <typename T, typename Meta = meta_type>
-    std::enable_if_t<!is_serializable_v<T>, T>
-    deserialize(binary_buffer_read& buffer) { return T(); }
+    // Serializes maps and sets: entry count, then key and mapped value of each entry
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>>
+    write_serializable(const mmfield* container, const void *from, binary_buffer_write& to) {
+        using arr_size_type = typename A::size_type;
+        using key_type = typename A::key_type;
+
+        const A* value = static_cast<const A*>(from);
+        arr_size_type entryCount = value->size();
+        write<arr_size_type>(container, &entryCount, to);
+        for(const auto& entry : *value) {
+            write<key_type>(container, &entry_key<A>(entry), to);
+            if constexpr (is_map_like_v<A>) {
+                write<typename A::mapped_type>(container, &entry.second, to);
+            }
+        }
+    }
 
-    // 'from' points to start of field in memory
-    // 'to' points to current write location in T
+    // Optionals outside of classes (containers, roots) are prefixed by a presence byte
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>>
+    write_serializable(const mmfield* container, const void *from, binary_buffer_write& to) {
+        const O* value = static_cast<const O*>(from);
+        const uint8_t present = value->has_value();
+        write<uint8_t>(container, &present, to);
+        if(present) {
+            write<typename O::value_type>(container, &**value, to);
+        }
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>>
+    write_serializable(const mmfield* container, const void *from, binary_buffer_write& to) {
+        using table = variant_table<V>;
+
+        const variant_tag_t<V> tag = table::tag_of(*static_cast<const V*>(from));
+        write<variant_tag_t<V>>(container, &tag, to);
+        if(tag < table::count) {
+            table::types[tag]->actions().Write(container, table::getters[tag](from), to);
+        }
+    }
+
+    // Number of bytes serialize() writes for 'value', computed without writing anything
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, size_t>
+    serialized_size(const T& value) { return binary_size<T>(nullptr, &value); }
+
+    // Same, for writing 'value' to 'to'. What an interned write takes depends on what the table has already
+    // seen, so streams with a binary_interner attached can't be sized up front.
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, size_t>
+    serialized_size(const T& value, binary_buffer_write& to) {
+        assert(!binary_interner::attached_to(to) && "serialized_size() doesn't account for interning.");
+        return serialized_size<T, Meta>(value);
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, size_t>
+    binary_size(const mmfield* self, const void *from) { return binary_size_serializable<T>(self, from); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>, size_t>
+    binary_size(const mmfield* self, const void *from) { return 0; }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<std::is_fundamental_v<T>, size_t>
+    binary_size_serializable(const mmfield* self, const void *from) { return sizeof(T); }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>, size_t>
+    binary_size_serializable(const mmfield* container, const void *from) {
+        size_t size = sizeof(hash_type) + presence_size<C>();
+        for_each_field<C>([&](const mmfield& field) {
+            const void *fieldValue = field.get_pointer_from(from);
+            if(const optional_actions* optional = field.type().actions().Optional) {
+                if(const void *value = optional->Find(fieldValue)) size += optional->ValueType->actions().Size(&field, value);
+            }
+            else {
+                size += field.type().actions().Size(&field, fieldValue);
+            }
+        });
+        return size;
+    }
+
+    template <typename D, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<D> || is_string_v<D>, size_t>
+    binary_size_serializable(const mmfield* container, const void *from) {
+        using arr_size_type = typename D::size_type;
+        using arr_value_type = typename D::value_type;
+
+        const D* value = static_cast<const D*>(from);
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            return sizeof(arr_size_type) + value->size() * sizeof(arr_value_type);
+        }
+        else {
+            size_t size = sizeof(arr_size_type);
+            for(const arr_value_type& element : *value) {
+                size += binary_size<arr_value_type, Meta>(container, &element);
+            }
+            return size;
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>, size_t>
+    binary_size_serializable(const mmfield* container, const void *from) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            return is_fixed_array<A>::size * sizeof(arr_value_type);
+        }
+        else {
+            size_t size = 0;
+            for(const arr_value_type& element : *static_cast<const A*>(from)) {
+                size += binary_size<arr_value_type, Meta>(container, &element);
+            }
+            return size;
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>, size_t>
+    binary_size_serializable(const mmfield* container, const void *from) {
+        size_t size = sizeof(typename A::size_type);
+        for(const auto& entry : *static_cast<const A*>(from)) {
+            size += binary_size<typename A::key_type, Meta>(container, &entry_key<A>(entry));
+            if constexpr (is_map_like_v<A>) {
+                size += binary_size<typename A::mapped_type, Meta>(container, &entry.second);
+            }
+        }
+        return size;
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>, size_t>
+    binary_size_serializable(const mmfield* container, const void *from) {
+        const O* value = static_cast<const O*>(from);
+        return sizeof(uint8_t) + (value->has_value() ? binary_size<typename O::value_type, Meta>(container, &**value) : 0);
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>, size_t>
+    binary_size_serializable(const mmfield* container, const void *from) {
+        using table = variant_table<V>;
+
+        const variant_tag_t<V> tag = table::tag_of(*static_cast<const V*>(from));
+        return sizeof(tag) + (tag < table::count ? table::types[tag]->actions().Size(container, table::getters[tag](from)) : 0);
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, T>
+    deserialize(binary_buffer_read& buffer) {
+        T inst;
+        read<T>(nullptr, buffer, (void*) &inst);
+        return inst;
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>, T>
+    deserialize(binary_buffer_read& buffer) { return T(); }
+
+    // Writes 'value' with its own interning table, repeated strings and vectors of fundamentals are
+    // only written once. Classes and other containers are always written in full, and there is no
+    // serialized_size() for interned output.
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>>
+    serialize_interned(const T& value, binary_buffer_write& data) {
+        binary_interner interner { data };
+        write<T, Meta>(nullptr, &value, data);
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, T>
+    deserialize_interned(binary_buffer_read& buffer) {
+        binary_intern_reader interner { buffer };
+        T inst;
+        read<T, Meta>(nullptr, buffer, &inst);
+        return inst;
+    }
+
+    // 'from' points to start of field in memory
+    // 'to' points to current write location in T
     template <typename T, typename Meta = meta_type>
     std::enable_if_t<!is_serializable_v<T>>
     read(const mmfield* fieldMeta, binary_buffer_read& from, void *to) {}
@@ -433,8 +1406,21 @@ namespace mmeta {
         
         assert(version == classmeta_v<C>.version() && "Trying to read binary from different version.");
 
+        presence_bits<C> presence{};
+        if constexpr (presence_size<C>() > 0) {
+            from.read(reinterpret_cast<binary_buffer_type*>(presence.data()), presence.size());
+        }
+
+        size_t optionalIndex = 0;
         for_each_field<C>([&](const mmfield& field) {
-            field.type().actions().Read(&field, from, field.get_pointer_from(to));
+            void *fieldValue = field.get_pointer_from(to);
+            if(const optional_actions* optional = field.type().actions().Optional) {
+                if(has_presence(presence.data(), optionalIndex++)) optional->ValueType->actions().Read(&field, from, optional->Emplace(fieldValue));
+                else optional->Reset(fieldValue);
+            }
+            else {
+                field.type().actions().Read(&field, from, fieldValue);
+            }
         });
     }
 
@@ -443,16 +1429,96 @@ namespace mmeta {
     read_serializable(const mmfield* fieldMeta, binary_buffer_read& from, void *to) {
         using arr_size_type = typename D::size_type;
         using arr_value_type = typename D::value_type;
+
+        D* value = static_cast<D*>(to);
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            if(binary_intern_reader* interner = binary_intern_reader::attached_to(from)) {
+                const std::string_view blob = interner->read(from);
+                // A blob of another element size is corrupt input, copying it would run past the vector
+                if(blob.size() % sizeof(arr_value_type) != 0) {
+                    from.setstate(std::ios::failbit);
+                    value->clear();
+                    return;
+                }
+                value->resize(blob.size() / sizeof(arr_value_type));
+                if(!value->empty()) memcpy(value->data(), blob.data(), value->size() * sizeof(arr_value_type));
+                return;
+            }
+        }
+
         arr_size_type size = 0;
         read<arr_size_type>(fieldMeta, from, &size);
 
-        D* value = static_cast<D*>(to);
         value->resize(size);
         for(arr_size_type i = 0; i < size; i++) {
             read<arr_value_type>(fieldMeta, from, value->data() + i);
         }
     }
 
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>>
+    read_serializable(const mmfield* fieldMeta, binary_buffer_read& from, void *to) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+        constexpr size_t elementCount = is_fixed_array<A>::size;
+
+        arr_value_type* elements = std::data(*static_cast<A*>(to));
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            from.read(reinterpret_cast<binary_buffer_type*>(elements), elementCount * sizeof(arr_value_type));
+        }
+        else {
+            for(size_t i = 0; i < elementCount; i++) {
+                read<arr_value_type>(fieldMeta, from, elements + i);
+            }
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>>
+    read_serializable(const mmfield* fieldMeta, binary_buffer_read& from, void *to) {
+        using arr_size_type = typename A::size_type;
+        using key_type = typename A::key_type;
+
+        arr_size_type size = 0;
+        read<arr_size_type>(fieldMeta, from, &size);
+
+        A* value = static_cast<A*>(to);
+        value->clear();
+        reserve_entries(*value, size);
+        for(arr_size_type i = 0; i < size; i++) {
+            key_type key{};
+            read<key_type>(fieldMeta, from, &key);
+            auto entry = emplace_entry(*value, std::move(key));
+            if constexpr (is_map_like_v<A>) {
+                read<typename A::mapped_type>(fieldMeta, from, &entry->second);
+            }
+        }
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>>
+    read_serializable(const mmfield* fieldMeta, binary_buffer_read& from, void *to) {
+        uint8_t present = 0;
+        read<uint8_t>(fieldMeta, from, &present);
+
+        O* value = static_cast<O*>(to);
+        if(present) read<typename O::value_type>(fieldMeta, from, &value->emplace());
+        else value->reset();
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>>
+    read_serializable(const mmfield* fieldMeta, binary_buffer_read& from, void *to) {
+        using table = variant_table<V>;
+
+        variant_tag_t<V> tag = 0;
+        read<variant_tag_t<V>>(fieldMeta, from, &tag);
+
+        assert(tag <= table::count && "Variant tag is out of range.");
+        if(tag < table::count) {
+            table::types[tag]->actions().Read(fieldMeta, from, table::emplacers[tag](to));
+        }
+    }
+
     // ========================================================================-------
     // ======= YAML Serialization
     // ========================================================================-------
@@ -486,6 +1552,79 @@ namespace mmeta {
         }
     }
 
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>>
+    write_serializable_yaml(const basic_mmfield<Meta>* self, const void* from, yaml_node& to) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+
+        for(const arr_value_type& val : *static_cast<const A*>(from)) {
+            yaml_node seqNode = yaml_node();
+            to.push_back(seqNode);
+            write_yaml<arr_value_type, Meta>(nullptr, &val, seqNode);
+        }
+    }
+
+    template <typename A, class = void>
+    struct is_unique_map : std::false_type {};
+
+    template <typename A>
+    struct is_unique_map<A, std::void_t<decltype(std::declval<A&>().try_emplace(std::declval<typename A::key_type>()))>> : std::true_type {};
+
+    // Maps with unique scalar keys can be written as YAML maps
+    template <typename A>
+    inline constexpr bool is_yaml_map_v = is_unique_map<A>::value &&
+                                          (std::is_fundamental_v<typename A::key_type> || is_string_v<typename A::key_type>);
+
+    // Maps with unique scalar keys become YAML maps, other maps become a sequence of key/value pairs and sets a sequence
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>>
+    write_serializable_yaml(const basic_mmfield<Meta>* self, const void* from, yaml_node& to) {
+        using key_type = typename A::key_type;
+
+        for(const auto& entry : *static_cast<const A*>(from)) {
+            if constexpr (is_yaml_map_v<A>) {
+                yaml_node valueNode = to[entry.first];
+                write_yaml<typename A::mapped_type, Meta>(nullptr, &entry.second, valueNode);
+            }
+            else if constexpr (is_map_like_v<A>) {
+                yaml_node seqNode = yaml_node();
+                yaml_node keyNode = seqNode["key"];
+                yaml_node valueNode = seqNode["value"];
+                write_yaml<key_type, Meta>(nullptr, &entry.first, keyNode);
+                write_yaml<typename A::mapped_type, Meta>(nullptr, &entry.second, valueNode);
+                to.push_back(seqNode);
+            }
+            else {
+                yaml_node seqNode = yaml_node();
+                to.push_back(seqNode);
+                write_yaml<key_type, Meta>(nullptr, &entry, seqNode);
+            }
+        }
+    }
+
+    // Empty optionals leave the node undefined, so they don't show up in the document
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>>
+    write_serializable_yaml(const basic_mmfield<Meta>* self, const void* from, yaml_node& to) {
+        const O* value = static_cast<const O*>(from);
+        if(value->has_value()) {
+            write_yaml<typename O::value_type, Meta>(self, &**value, to);
+        }
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>>
+    write_serializable_yaml(const basic_mmfield<Meta>* self, const void* from, yaml_node& to) {
+        using table = variant_table<V>;
+
+        const variant_tag_t<V> tag = table::tag_of(*static_cast<const V*>(from));
+        if(tag == table::count) return;
+
+        to["index"] = static_cast<size_t>(tag);
+        yaml_node valueNode = to["value"];
+        table::types[tag]->actions().WriteYAML(self, table::getters[tag](from), valueNode);
+    }
+
     template <typename T, typename Meta = meta_type>
     std::enable_if_t<is_serializable_v<T>>
     write_yaml(const basic_mmfield<Meta>* self, const void* from, yaml_node& to) { write_serializable_yaml<T>(self, from, to); }
@@ -552,10 +1691,2300 @@ namespace mmeta {
         }
     }
 
+    // Extra entries are ignored, missing ones keep their current value
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>>
+    read_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+        constexpr size_t elementCount = is_fixed_array<A>::size;
+
+        arr_value_type* elements = std::data(*static_cast<A*>(to));
+        size_t i = 0;
+        for(auto& yamlField : from) {
+            if(i == elementCount) break;
+            read_yaml<arr_value_type>(self, yamlField, elements + i);
+            i++;
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>>
+    read_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        using key_type = typename A::key_type;
+
+        A* value = static_cast<A*>(to);
+        value->clear();
+        reserve_entries(*value, from.size());
+        for(auto yamlEntry : from) {
+            key_type key{};
+            if constexpr (is_yaml_map_v<A>) {
+                key = yamlEntry.first.template as<key_type>();
+                auto entry = emplace_entry(*value, std::move(key));
+                read_yaml<typename A::mapped_type>(self, yamlEntry.second, &entry->second);
+            }
+            else if constexpr (is_map_like_v<A>) {
+                read_yaml<key_type>(self, yamlEntry["key"], &key);
+                auto entry = emplace_entry(*value, std::move(key));
+                read_yaml<typename A::mapped_type>(self, yamlEntry["value"], &entry->second);
+            }
+            else {
+                read_yaml<key_type>(self, yamlEntry, &key);
+                emplace_entry(*value, std::move(key));
+            }
+        }
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>>
+    read_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        O* value = static_cast<O*>(to);
+        if(!from.IsDefined() || from.IsNull()) value->reset();
+        else read_yaml<typename O::value_type>(self, from, &value->emplace());
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>>
+    read_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        using table = variant_table<V>;
+
+        const yaml_node index = from["index"];
+        if(!index.IsDefined()) return;
+
+        const size_t tag = index.as<size_t>();
+        if(tag < table::count) {
+            table::types[tag]->actions().ReadYAML(self, from["value"], table::emplacers[tag](to));
+        }
+    }
+
+    // ========================================================================-------
+    // ======= Columnar Serialization
+    // ========================================================================-------
+
+    // Batches of records are written as one schema header followed by one column per fundamental leaf.
+    // Strings and vectors become a column of offsets, named after the field, followed by the columns of
+    // their elements, named with a "[]" suffix, e.g: "m_targets", "m_targets[].X", "m_targets[].Y"...
+    // Every column starts 8-byte aligned relative to the start of the batch, so it can be read in place.
+
+    using column_offset_type = uint64_t;
+    static constexpr size_t kColumnAlignment = 8;
+
+    inline size_t column_padding(size_t size) {
+        return (kColumnAlignment - size % kColumnAlignment) % kColumnAlignment;
+    }
+
+    struct column_desc {
+        std::string Path;
+        hash_type Type;
+        uint64_t Size;
+    };
+
+    // Receives the columns of a batch. Without a buffer, it only records their schema.
+    class column_sink {
+    public:
+        explicit column_sink(binary_buffer_write* data = nullptr) : m_data(data) {}
+
+        // Returns the buffer the column should be written to, or nullptr if only the schema is being recorded
+        binary_buffer_write* begin_column(const std::string& path, hash_type type, uint64_t size) {
+            if(!m_data) {
+                m_columns.push_back({ path, type, size });
+            }
+            return m_data;
+        }
+
+        void end_column(uint64_t size) {
+            static constexpr binary_buffer_type padding[kColumnAlignment] = {};
+            if(m_data) {
+                m_data->write(padding, column_padding(size));
+            }
+        }
+
+        const std::vector<column_desc>& columns() const { return m_columns; }
+
+    private:
+        binary_buffer_write* m_data;
+        std::vector<column_desc> m_columns;
+    };
+
+    class column_source {
+    public:
+        column_source(binary_buffer_read& data, std::vector<column_desc> columns) : m_data(data), m_columns(std::move(columns)) {}
+
+        binary_buffer_read& begin_column(uint64_t size) {
+            assert(m_next < m_columns.size() && m_columns[m_next].Size == size && "Columnar batch doesn't match the schema.");
+            return m_data;
+        }
+
+        void end_column() {
+            m_data.ignore(column_padding(m_columns[m_next].Size));
+            m_next++;
+        }
+
+    private:
+        binary_buffer_read& m_data;
+        std::vector<column_desc> m_columns;
+        size_t m_next = 0;
+    };
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>>
+    write_column(const mmfield* self, const std::string& path, const void * const * values, size_t count, column_sink& to) { write_serializable_column<T>(self, path, values, count, to); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>>
+    write_column(const mmfield* self, const std::string& path, const void * const * values, size_t count, column_sink& to) {}
+
+    template <typename P, typename Meta = meta_type>
+    std::enable_if_t<std::is_fundamental_v<P>>
+    write_serializable_column(const mmfield* self, const std::string& path, const void * const * values, size_t count, column_sink& to) {
+        const uint64_t size = count * sizeof(P);
+        if(binary_buffer_write* data = to.begin_column(path, typemeta_v<P>.hash(), size)) {
+            // Not a std::vector, which has no data() for bool
+            std::unique_ptr<P[]> gathered = std::make_unique<P[]>(count);
+            for(size_t i = 0; i < count; i++) {
+                gathered[i] = *static_cast<const P*>(values[i]);
+            }
+            data->write(reinterpret_cast<const binary_buffer_type*>(gathered.get()), size);
+        }
+        to.end_column(size);
+    }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>>
+    write_serializable_column(const mmfield* self, const std::string& path, const void * const * values, size_t count, column_sink& to) {
+        std::vector<const void*> fieldValues(count);
+        for_each_field<C>([&](const mmfield& field) {
+            for(size_t i = 0; i < count; i++) {
+                fieldValues[i] = field.get_pointer_from(values[i]);
+            }
+            const std::string fieldPath = path.empty() ? std::string(field.name()) : path + "." + std::string(field.name());
+            field.type().actions().WriteColumn(&field, fieldPath, fieldValues.data(), count, to);
+        });
+    }
+
+    template <typename D, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<D> || is_string_v<D>>
+    write_serializable_column(const mmfield* self, const std::string& path, const void * const * values, size_t count, column_sink& to) {
+        using arr_value_type = typename D::value_type;
+
+        std::vector<column_offset_type> offsets(count + 1, 0);
+        for(size_t i = 0; i < count; i++) {
+            offsets[i + 1] = offsets[i] + static_cast<const D*>(values[i])->size();
+        }
+
+        const uint64_t offsetsSize = offsets.size() * sizeof(column_offset_type);
+        if(binary_buffer_write* data = to.begin_column(path, typemeta_v<column_offset_type>.hash(), offsetsSize)) {
+            data->write(reinterpret_cast<const binary_buffer_type*>(offsets.data()), offsetsSize);
+        }
+        to.end_column(offsetsSize);
+
+        const std::string elementsPath = path + "[]";
+        const size_t elementCount = offsets.back();
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            // Elements are already contiguous, so each one is written with a single bulk copy
+            const uint64_t elementsSize = elementCount * sizeof(arr_value_type);
+            if(binary_buffer_write* data = to.begin_column(elementsPath, typemeta_v<arr_value_type>.hash(), elementsSize)) {
+                for(size_t i = 0; i < count; i++) {
+                    const D* value = static_cast<const D*>(values[i]);
+                    data->write(reinterpret_cast<const binary_buffer_type*>(value->data()), value->size() * sizeof(arr_value_type));
+                }
+            }
+            to.end_column(elementsSize);
+        }
+        else {
+            std::vector<const void*> elements;
+            elements.reserve(elementCount);
+            for(size_t i = 0; i < count; i++) {
+                for(const auto& element : *static_cast<const D*>(values[i])) {
+                    elements.push_back(&element);
+                }
+            }
+            write_column<arr_value_type>(self, elementsPath, elements.data(), elementCount, to);
+        }
+    }
+
+    // Fixed-size arrays don't need an offsets column, each record takes the same number of elements
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>>
+    write_serializable_column(const mmfield* self, const std::string& path, const void * const * values, size_t count, column_sink& to) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+        constexpr size_t arraySize = is_fixed_array<A>::size;
+
+        const std::string elementsPath = path + "[]";
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            const uint64_t elementsSize = count * arraySize * sizeof(arr_value_type);
+            if(binary_buffer_write* data = to.begin_column(elementsPath, typemeta_v<arr_value_type>.hash(), elementsSize)) {
+                for(size_t i = 0; i < count; i++) {
+                    data->write(static_cast<const binary_buffer_type*>(values[i]), arraySize * sizeof(arr_value_type));
+                }
+            }
+            to.end_column(elementsSize);
+        }
+        else {
+            std::vector<const void*> elements;
+            elements.reserve(count * arraySize);
+            for(size_t i = 0; i < count; i++) {
+                for(const auto& element : *static_cast<const A*>(values[i])) {
+                    elements.push_back(&element);
+                }
+            }
+            write_column<arr_value_type>(self, elementsPath, elements.data(), elements.size(), to);
+        }
+    }
+
+    // Maps and sets get an offsets column like vectors, then a column for keys and one for mapped values
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>>
+    write_serializable_column(const mmfield* self, const std::string& path, const void * const * values, size_t count, column_sink& to) {
+        std::vector<column_offset_type> offsets(count + 1, 0);
+        for(size_t i = 0; i < count; i++) {
+            offsets[i + 1] = offsets[i] + static_cast<const A*>(values[i])->size();
+        }
+
+        const uint64_t offsetsSize = offsets.size() * sizeof(column_offset_type);
+        if(binary_buffer_write* data = to.begin_column(path, typemeta_v<column_offset_type>.hash(), offsetsSize)) {
+            data->write(reinterpret_cast<const binary_buffer_type*>(offsets.data()), offsetsSize);
+        }
+        to.end_column(offsetsSize);
+
+        std::vector<const void*> keys;
+        std::vector<const void*> mapped;
+        keys.reserve(offsets.back());
+        for(size_t i = 0; i < count; i++) {
+            for(const auto& entry : *static_cast<const A*>(values[i])) {
+                keys.push_back(&entry_key<A>(entry));
+                if constexpr (is_map_like_v<A>) mapped.push_back(&entry.second);
+            }
+        }
+
+        if constexpr (is_map_like_v<A>) {
+            write_column<typename A::key_type>(self, path + "[].key", keys.data(), keys.size(), to);
+            write_column<typename A::mapped_type>(self, path + "[].value", mapped.data(), mapped.size(), to);
+        }
+        else {
+            write_column<typename A::key_type>(self, path + "[]", keys.data(), keys.size(), to);
+        }
+    }
+
+    // A presence column, then the columns of the values that are present
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>>
+    write_serializable_column(const mmfield* self, const std::string& path, const void * const * values, size_t count, column_sink& to) {
+        std::vector<uint8_t> presence(count);
+        std::vector<const void*> present;
+        for(size_t i = 0; i < count; i++) {
+            const O* value = static_cast<const O*>(values[i]);
+            presence[i] = value->has_value();
+            if(presence[i]) present.push_back(&**value);
+        }
+
+        if(binary_buffer_write* data = to.begin_column(path + "?", typemeta_v<uint8_t>.hash(), count)) {
+            data->write(reinterpret_cast<const binary_buffer_type*>(presence.data()), count);
+        }
+        to.end_column(count);
+
+        write_column<typename O::value_type>(self, path, present.data(), present.size(), to);
+    }
+
+    // A tag column, then one set of columns per alternative with the values that hold it
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>>
+    write_serializable_column(const mmfield* self, const std::string& path, const void * const * values, size_t count, column_sink& to) {
+        using table = variant_table<V>;
+        using tag_type = variant_tag_t<V>;
+
+        std::vector<tag_type> tags(count);
+        std::vector<std::vector<const void*>> alternatives(table::count);
+        for(size_t i = 0; i < count; i++) {
+            tags[i] = table::tag_of(*static_cast<const V*>(values[i]));
+            if(tags[i] < table::count) alternatives[tags[i]].push_back(table::getters[tags[i]](values[i]));
+        }
+
+        const uint64_t tagsSize = count * sizeof(tag_type);
+        if(binary_buffer_write* data = to.begin_column(path + "#", typemeta_v<tag_type>.hash(), tagsSize)) {
+            data->write(reinterpret_cast<const binary_buffer_type*>(tags.data()), tagsSize);
+        }
+        to.end_column(tagsSize);
+
+        for(size_t k = 0; k < table::count; k++) {
+            const std::string alternativePath = path + "<" + std::to_string(k) + ">";
+            table::types[k]->actions().WriteColumn(self, alternativePath, alternatives[k].data(), alternatives[k].size(), to);
+        }
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>>
+    read_column(const mmfield* self, column_source& from, void * const * values, size_t count) { read_serializable_column<T>(self, from, values, count); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>>
+    read_column(const mmfield* self, column_source& from, void * const * values, size_t count) {}
+
+    template <typename P, typename Meta = meta_type>
+    std::enable_if_t<std::is_fundamental_v<P>>
+    read_serializable_column(const mmfield* self, column_source& from, void * const * values, size_t count) {
+        const uint64_t size = count * sizeof(P);
+        std::unique_ptr<P[]> gathered = std::make_unique<P[]>(count);
+        from.begin_column(size).read(reinterpret_cast<binary_buffer_type*>(gathered.get()), size);
+        from.end_column();
+
+        for(size_t i = 0; i < count; i++) {
+            *static_cast<P*>(values[i]) = gathered[i];
+        }
+    }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>>
+    read_serializable_column(const mmfield* self, column_source& from, void * const * values, size_t count) {
+        std::vector<void*> fieldValues(count);
+        for_each_field<C>([&](const mmfield& field) {
+            for(size_t i = 0; i < count; i++) {
+                fieldValues[i] = field.get_pointer_from(values[i]);
+            }
+            field.type().actions().ReadColumn(&field, from, fieldValues.data(), count);
+        });
+    }
+
+    template <typename D, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<D> || is_string_v<D>>
+    read_serializable_column(const mmfield* self, column_source& from, void * const * values, size_t count) {
+        using arr_value_type = typename D::value_type;
+
+        std::vector<column_offset_type> offsets(count + 1, 0);
+        const uint64_t offsetsSize = offsets.size() * sizeof(column_offset_type);
+        from.begin_column(offsetsSize).read(reinterpret_cast<binary_buffer_type*>(offsets.data()), offsetsSize);
+        from.end_column();
+
+        for(size_t i = 0; i < count; i++) {
+            static_cast<D*>(values[i])->resize(offsets[i + 1] - offsets[i]);
+        }
+
+        const size_t elementCount = offsets.back();
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            binary_buffer_read& data = from.begin_column(elementCount * sizeof(arr_value_type));
+            for(size_t i = 0; i < count; i++) {
+                D* value = static_cast<D*>(values[i]);
+                data.read(reinterpret_cast<binary_buffer_type*>(value->data()), value->size() * sizeof(arr_value_type));
+            }
+            from.end_column();
+        }
+        else {
+            std::vector<void*> elements;
+            elements.reserve(elementCount);
+            for(size_t i = 0; i < count; i++) {
+                for(auto& element : *static_cast<D*>(values[i])) {
+                    elements.push_back(&element);
+                }
+            }
+            read_column<arr_value_type>(self, from, elements.data(), elementCount);
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>>
+    read_serializable_column(const mmfield* self, column_source& from, void * const * values, size_t count) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+        constexpr size_t arraySize = is_fixed_array<A>::size;
+
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            binary_buffer_read& data = from.begin_column(count * arraySize * sizeof(arr_value_type));
+            for(size_t i = 0; i < count; i++) {
+                data.read(static_cast<binary_buffer_type*>(values[i]), arraySize * sizeof(arr_value_type));
+            }
+            from.end_column();
+        }
+        else {
+            std::vector<void*> elements;
+            elements.reserve(count * arraySize);
+            for(size_t i = 0; i < count; i++) {
+                for(auto& element : *static_cast<A*>(values[i])) {
+                    elements.push_back(&element);
+                }
+            }
+            read_column<arr_value_type>(self, from, elements.data(), elements.size());
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>>
+    read_serializable_column(const mmfield* self, column_source& from, void * const * values, size_t count) {
+        using key_type = typename A::key_type;
+
+        std::vector<column_offset_type> offsets(count + 1, 0);
+        const uint64_t offsetsSize = offsets.size() * sizeof(column_offset_type);
+        from.begin_column(offsetsSize).read(reinterpret_cast<binary_buffer_type*>(offsets.data()), offsetsSize);
+        from.end_column();
+
+        // Keys have to be known before their nodes exist, mapped values are then read straight into the nodes
+        const size_t entryCount = offsets.back();
+        std::vector<key_type> keys(entryCount);
+        std::vector<void*> keyValues(entryCount);
+        for(size_t i = 0; i < entryCount; i++) {
+            keyValues[i] = &keys[i];
+        }
+        read_column<key_type>(self, from, keyValues.data(), entryCount);
+
+        std::vector<void*> mapped;
+        mapped.reserve(is_map_like_v<A> ? entryCount : 0);
+        for(size_t i = 0; i < count; i++) {
+            A* value = static_cast<A*>(values[i]);
+            value->clear();
+            reserve_entries(*value, offsets[i + 1] - offsets[i]);
+            for(size_t k = offsets[i]; k < offsets[i + 1]; k++) {
+                auto entry = emplace_entry(*value, std::move(keys[k]));
+                if constexpr (is_map_like_v<A>) mapped.push_back(&entry->second);
+            }
+        }
+
+        if constexpr (is_map_like_v<A>) {
+            read_column<typename A::mapped_type>(self, from, mapped.data(), mapped.size());
+        }
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>>
+    read_serializable_column(const mmfield* self, column_source& from, void * const * values, size_t count) {
+        std::vector<uint8_t> presence(count);
+        from.begin_column(count).read(reinterpret_cast<binary_buffer_type*>(presence.data()), count);
+        from.end_column();
+
+        std::vector<void*> present;
+        for(size_t i = 0; i < count; i++) {
+            O* value = static_cast<O*>(values[i]);
+            if(presence[i]) present.push_back(&value->emplace());
+            else value->reset();
+        }
+        read_column<typename O::value_type>(self, from, present.data(), present.size());
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>>
+    read_serializable_column(const mmfield* self, column_source& from, void * const * values, size_t count) {
+        using table = variant_table<V>;
+        using tag_type = variant_tag_t<V>;
+
+        std::vector<tag_type> tags(count);
+        const uint64_t tagsSize = count * sizeof(tag_type);
+        from.begin_column(tagsSize).read(reinterpret_cast<binary_buffer_type*>(tags.data()), tagsSize);
+        from.end_column();
+
+        std::vector<std::vector<void*>> alternatives(table::count);
+        for(size_t i = 0; i < count; i++) {
+            if(tags[i] < table::count) alternatives[tags[i]].push_back(table::emplacers[tags[i]](values[i]));
+        }
+        for(size_t k = 0; k < table::count; k++) {
+            table::types[k]->actions().ReadColumn(self, from, alternatives[k].data(), alternatives[k].size());
+        }
+    }
+
+    // Header: class version, record count, column count and then path, type and size of each column
+    inline void write_column_schema(hash_type version, uint64_t recordCount, const std::vector<column_desc>& columns, binary_buffer_write& to) {
+        const uint32_t columnCount = static_cast<uint32_t>(columns.size());
+        size_t headerSize = sizeof(version) + sizeof(recordCount) + sizeof(columnCount);
+
+        to.write(reinterpret_cast<const binary_buffer_type*>(&version), sizeof(version));
+        to.write(reinterpret_cast<const binary_buffer_type*>(&recordCount), sizeof(recordCount));
+        to.write(reinterpret_cast<const binary_buffer_type*>(&columnCount), sizeof(columnCount));
+        for(const auto& column : columns) {
+            const uint32_t pathSize = static_cast<uint32_t>(column.Path.size());
+            to.write(reinterpret_cast<const binary_buffer_type*>(&pathSize), sizeof(pathSize));
+            to.write(column.Path.data(), pathSize);
+            to.write(reinterpret_cast<const binary_buffer_type*>(&column.Type), sizeof(column.Type));
+            to.write(reinterpret_cast<const binary_buffer_type*>(&column.Size), sizeof(column.Size));
+            headerSize += sizeof(pathSize) + pathSize + sizeof(column.Type) + sizeof(column.Size);
+        }
+
+        static constexpr binary_buffer_type padding[kColumnAlignment] = {};
+        to.write(padding, column_padding(headerSize));
+    }
+
+    inline std::vector<column_desc> read_column_schema(binary_buffer_read& from, hash_type& version, uint64_t& recordCount) {
+        uint32_t columnCount = 0;
+        size_t headerSize = sizeof(version) + sizeof(recordCount) + sizeof(columnCount);
+
+        from.read(reinterpret_cast<binary_buffer_type*>(&version), sizeof(version));
+        from.read(reinterpret_cast<binary_buffer_type*>(&recordCount), sizeof(recordCount));
+        from.read(reinterpret_cast<binary_buffer_type*>(&columnCount), sizeof(columnCount));
+
+        std::vector<column_desc> columns(columnCount);
+        for(auto& column : columns) {
+            uint32_t pathSize = 0;
+            from.read(reinterpret_cast<binary_buffer_type*>(&pathSize), sizeof(pathSize));
+            column.Path.resize(pathSize);
+            from.read(&column.Path[0], pathSize);
+            from.read(reinterpret_cast<binary_buffer_type*>(&column.Type), sizeof(column.Type));
+            from.read(reinterpret_cast<binary_buffer_type*>(&column.Size), sizeof(column.Size));
+            headerSize += sizeof(pathSize) + pathSize + sizeof(column.Type) + sizeof(column.Size);
+        }
+
+        from.ignore(column_padding(headerSize));
+        return columns;
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<T>>
+    serialize_columns(const std::vector<T>& records, binary_buffer_write& data) {
+        std::vector<const void*> values(records.size());
+        for(size_t i = 0; i < records.size(); i++) {
+            values[i] = &records[i];
+        }
+
+        // First pass only collects the schema, so the header can be written before the columns
+        column_sink schema;
+        write_column<T>(nullptr, "", values.data(), values.size(), schema);
+        write_column_schema(classmeta_v<T>.version(), records.size(), schema.columns(), data);
+
+        column_sink sink { &data };
+        write_column<T>(nullptr, "", values.data(), values.size(), sink);
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<T>, std::vector<T>>
+    deserialize_columns(binary_buffer_read& data) {
+        hash_type version = 0;
+        uint64_t recordCount = 0;
+        std::vector<column_desc> columns = read_column_schema(data, version, recordCount);
+
+        assert(version == classmeta_v<T>.version() && "Trying to read binary from different version.");
+
+        std::vector<T> records(recordCount);
+        std::vector<void*> values(records.size());
+        for(size_t i = 0; i < records.size(); i++) {
+            values[i] = &records[i];
+        }
+
+        column_source source { data, std::move(columns) };
+        read_column<T>(nullptr, source, values.data(), values.size());
+        return records;
+    }
+
+    // Reads the schema of a batch that's already in memory, so single columns can be scanned in place
+    class columnar_view {
+    public:
+        struct column_ref {
+            std::string_view Path;
+            hash_type Type;
+            const binary_buffer_type *Data;
+            uint64_t Size;
+
+            template <typename F>
+            const F* as() const {
+                assert(utils::hash(utils::type_name<F>::name) == Type && ">> ERROR: Trying to get column using wrong type.");
+                return reinterpret_cast<const F*>(Data);
+            }
+
+            template <typename F>
+            size_t count() const { return static_cast<size_t>(Size / sizeof(F)); }
+        };
+
+        columnar_view(const binary_buffer_type *data, size_t size) {
+            const binary_buffer_type *cursor = data;
+            auto read_value = [&](auto& value) {
+                assert(cursor + sizeof(value) <= data + size && "Columnar batch is truncated.");
+                memcpy(&value, cursor, sizeof(value));
+                cursor += sizeof(value);
+            };
+
+            uint32_t columnCount = 0;
+            read_value(m_version);
+            read_value(m_recordCount);
+            read_value(columnCount);
+
+            m_columns.resize(columnCount);
+            for(auto& column : m_columns) {
+                uint32_t pathSize = 0;
+                read_value(pathSize);
+                column.Path = { cursor, pathSize };
+                cursor += pathSize;
+                read_value(column.Type);
+                read_value(column.Size);
+            }
+
+            cursor += column_padding(static_cast<size_t>(cursor - data));
+            for(auto& column : m_columns) {
+                assert(cursor + column.Size <= data + size && "Columnar batch is truncated.");
+                column.Data = cursor;
+                cursor += column.Size + column_padding(column.Size);
+            }
+        }
+
+        hash_type version() const { return m_version; }
+        uint64_t record_count() const { return m_recordCount; }
+        const std::vector<column_ref>& columns() const { return m_columns; }
+
+        const column_ref* find(std::string_view path) const {
+            for(const auto& column : m_columns) {
+                if(column.Path == path) return &column;
+            }
+            return nullptr;
+        }
+
+    private:
+        hash_type m_version = 0;
+        uint64_t m_recordCount = 0;
+        std::vector<column_ref> m_columns;
+    };
+
+    // ========================================================================-------
+    // ======= Incremental Decoding
+    // ========================================================================-------
+
+    // Bounds untrusted input can't push a decoder past
+    struct decode_limits {
+        size_t MaxAllocation = size_t(256) << 20;     // Bytes all containers together may allocate
+        size_t MaxDepth = 64;                          // Nested classes and containers
+    };
+
+    enum class decode_status {
+        need_more_data,
+        done,
+        error           // Input was written by a different version of the class, or went past the decode limits
+    };
+
+    // Decodes the binary format from chunks of bytes as they arrive. Progress lives in an explicit stack
+    // of frames, one per value being decoded, so bytes are never parsed twice.
+    //      mmeta::incremental_decoder decoder;
+    //      decoder.reset(player);
+    //      while(decoder.feed(chunk, chunkSize) == mmeta::decode_status::need_more_data) { ... }
+    class incremental_decoder {
+    public:
+        enum class step_result {
+            finished,
+            need_more,
+            descend,        // A frame was pushed for a nested value
+            failed
+        };
+
+        struct frame {
+            using StepFn = step_result (*)(incremental_decoder&, frame&);
+
+            StepFn Step = nullptr;
+            void *Target = nullptr;
+            size_t Index = 0;
+            size_t Count = 0;
+            size_t Filled = 0;      // Bytes copied to the value that's currently being read
+            uint64_t Scratch = 0;
+            std::shared_ptr<void> Staging;      // Entries decoded before they can be inserted
+        };
+
+        template <typename T>
+        std::enable_if_t<is_serializable_v<T>>
+        reset(T& target, decode_limits limits = {});
+
+        // Consumes bytes until the value is done or the chunk runs out. If the value finishes
+        // before the end of the chunk, consumed() tells where the next message starts.
+        decode_status feed(const binary_buffer_type *data, size_t size) {
+            m_input = data;
+            m_inputEnd = data + size;
+            const decode_status status = run();
+            m_consumed = static_cast<size_t>(m_input - data);
+            return status;
+        }
+
+        size_t consumed() const { return m_consumed; }
+        bool done() const { return m_stack.empty() && !m_failed; }
+
+        void push(frame::StepFn step, void *target) {
+            frame& next = m_stack.emplace_back();
+            next.Step = step;
+            next.Target = target;
+        }
+
+        // Whether 'count' elements of 'elementSize' bytes fit in what's left of the allocation budget, takes them if so.
+        // Lengths come straight from the input, so containers are checked before they grow.
+        bool reserve(size_t count, size_t elementSize) {
+            if(count > m_allocationLeft / elementSize) return false;
+            m_allocationLeft -= count * elementSize;
+            return true;
+        }
+
+        // Bytes left in the current chunk
+        size_t available() const { return static_cast<size_t>(m_inputEnd - m_input); }
+
+        // Copies input into 'to' until 'size' bytes were filled, returns whether it got there
+        bool take(void *to, size_t size, size_t& filled) {
+            const size_t available = static_cast<size_t>(m_inputEnd - m_input);
+            const size_t count = size - filled < available ? size - filled : available;
+            if(count > 0) {
+                memcpy(static_cast<binary_buffer_type*>(to) + filled, m_input, count);
+                m_input += count;
+                filled += count;
+            }
+            return filled == size;
+        }
+
+    private:
+        decode_status run() {
+            if(m_failed) return decode_status::error;
+
+            while(!m_stack.empty()) {
+                frame& top = m_stack.back();
+                switch(top.Step(*this, top)) {
+                    case step_result::finished:
+                        m_stack.pop_back();
+                        break;
+                    case step_result::descend:
+                        // The innermost frame is the value being read, everything above it counts as nesting
+                        if(m_stack.size() > m_limits.MaxDepth + 1) {
+                            m_failed = true;
+                            return decode_status::error;
+                        }
+                        break;
+                    case step_result::need_more:
+                        return decode_status::need_more_data;
+                    case step_result::failed:
+                        m_failed = true;
+                        return decode_status::error;
+                }
+            }
+            return decode_status::done;
+        }
+
+        std::vector<frame> m_stack;
+        decode_limits m_limits;
+        size_t m_allocationLeft = 0;
+        const binary_buffer_type *m_input = nullptr;
+        const binary_buffer_type *m_inputEnd = nullptr;
+        size_t m_consumed = 0;
+        bool m_failed = false;
+    };
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>>
+    push_decode(incremental_decoder& decoder, void *to);
+
+    template <typename T>
+    constexpr size_t min_wire_size();
+
+    template <typename A>
+    constexpr size_t entry_allocation_size();
+
+    template <typename P, typename Meta = meta_type>
+    std::enable_if_t<std::is_fundamental_v<P>, incremental_decoder::step_result>
+    decode_step(incremental_decoder& decoder, incremental_decoder::frame& frame) {
+        return decoder.take(frame.Target, sizeof(P), frame.Filled) ? incremental_decoder::step_result::finished : incremental_decoder::step_result::need_more;
+    }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>, incremental_decoder::step_result>
+    decode_step(incremental_decoder& decoder, incremental_decoder::frame& frame) {
+        using step_result = incremental_decoder::step_result;
+
+        constexpr size_t presenceSize = presence_size<C>();
+        if(frame.Index == 0) {
+            if(!decoder.take(&frame.Scratch, sizeof(hash_type), frame.Filled)) return step_result::need_more;
+            if(frame.Scratch != classmeta_v<C>.version()) return step_result::failed;
+            frame.Index = 1;
+            frame.Filled = 0;
+            frame.Scratch = 0;
+            if constexpr (presenceSize > sizeof(frame.Scratch)) frame.Staging = std::make_shared<presence_bits<C>>();
+        }
+
+        // Presence bits live in Scratch, unless the class has more than 64 optional fields
+        uint8_t *presence = reinterpret_cast<uint8_t*>(&frame.Scratch);
+        if constexpr (presenceSize > sizeof(frame.Scratch)) presence = static_cast<presence_bits<C>*>(frame.Staging.get())->data();
+        if(!decoder.take(presence, presenceSize, frame.Filled)) return step_result::need_more;
+
+        const fieldseq fields = classmeta_v<C>.fields();
+        if(frame.Index > fields.size()) return step_result::finished;
+
+        const mmfield& field = fields.begin()[frame.Index++ - 1];
+        void *fieldValue = field.get_pointer_from(frame.Target);
+        if(const optional_actions* optional = field.type().actions().Optional) {
+            // Count holds how many optional fields were visited
+            if(!has_presence(presence, frame.Count++)) {
+                optional->Reset(fieldValue);
+                return step_result::descend;
+            }
+            optional->ValueType->actions().PushDecode(decoder, optional->Emplace(fieldValue));
+        }
+        else {
+            field.type().actions().PushDecode(decoder, fieldValue);
+        }
+        return step_result::descend;
+    }
+
+    template <typename D, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<D> || is_string_v<D>, incremental_decoder::step_result>
+    decode_step(incremental_decoder& decoder, incremental_decoder::frame& frame) {
+        using step_result = incremental_decoder::step_result;
+        using arr_size_type = typename D::size_type;
+        using arr_value_type = typename D::value_type;
+
+        // The length isn't trusted, the container only grows as its elements arrive
+        D* value = static_cast<D*>(frame.Target);
+        if(frame.Index == 0) {
+            if(!decoder.take(&frame.Scratch, sizeof(arr_size_type), frame.Filled)) return step_result::need_more;
+            frame.Count = static_cast<size_t>(frame.Scratch);
+            if(!decoder.reserve(frame.Count, sizeof(arr_value_type))) return step_result::failed;
+            frame.Filled = 0;
+            frame.Index = 1;
+            value->clear();
+        }
+
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            const size_t totalSize = frame.Count * sizeof(arr_value_type);
+            const size_t arrived = frame.Filled + std::min(totalSize - frame.Filled, decoder.available());
+            value->resize((arrived + sizeof(arr_value_type) - 1) / sizeof(arr_value_type));
+            return decoder.take(value->data(), totalSize, frame.Filled) ? step_result::finished : step_result::need_more;
+        }
+        else {
+            if(frame.Index > frame.Count) return step_result::finished;
+            if(value->size() == value->capacity()) {
+                // Grows 4x at a time, moving elements that hold allocations is what makes growing slow, but never
+                // past the length or past what the buffered input can still hold
+                constexpr size_t minWireSize = min_wire_size<arr_value_type>() > 0 ? min_wire_size<arr_value_type>() : 1;
+                const size_t byInput = decoder.available() / minWireSize + 1;
+                const size_t growth = 3 * value->size() > byInput ? 3 * value->size() : byInput;
+                value->reserve(std::min(frame.Count, value->size() + growth));
+            }
+            frame.Index++;
+            push_decode<arr_value_type, Meta>(decoder, &value->emplace_back());
+            return step_result::descend;
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>, incremental_decoder::step_result>
+    decode_step(incremental_decoder& decoder, incremental_decoder::frame& frame) {
+        using step_result = incremental_decoder::step_result;
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+        constexpr size_t elementCount = is_fixed_array<A>::size;
+
+        arr_value_type* elements = std::data(*static_cast<A*>(frame.Target));
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            return decoder.take(elements, elementCount * sizeof(arr_value_type), frame.Filled) ? step_result::finished : step_result::need_more;
+        }
+        else {
+            if(frame.Index == elementCount) return step_result::finished;
+            push_decode<arr_value_type, Meta>(decoder, elements + frame.Index++);
+            return step_result::descend;
+        }
+    }
+
+    template <typename A, bool = is_map_like_v<A>>
+    struct staged_entry { using type = typename A::key_type; };
+
+    template <typename A>
+    struct staged_entry<A, true> { using type = std::pair<typename A::key_type, typename A::mapped_type>; };
+
+    // Entries can't be inserted until their key is complete, so they're staged until all of them arrived
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>, incremental_decoder::step_result>
+    decode_step(incremental_decoder& decoder, incremental_decoder::frame& frame) {
+        using step_result = incremental_decoder::step_result;
+        using arr_size_type = typename A::size_type;
+        using key_type = typename A::key_type;
+        using staged_type = typename staged_entry<A>::type;
+        constexpr size_t partsPerEntry = is_map_like_v<A> ? 2 : 1;
+
+        if(frame.Index == 0) {
+            if(!decoder.take(&frame.Scratch, sizeof(arr_size_type), frame.Filled)) return step_result::need_more;
+            frame.Count = static_cast<size_t>(frame.Scratch);
+            if(!decoder.reserve(frame.Count, entry_allocation_size<A>())) return step_result::failed;
+            frame.Staging = std::make_shared<std::vector<staged_type>>();
+            frame.Index = 1;
+        }
+
+        auto& staged = *static_cast<std::vector<staged_type>*>(frame.Staging.get());
+        const size_t part = frame.Index - 1;
+        if(part < frame.Count * partsPerEntry) {
+            frame.Index++;
+            if(part % partsPerEntry == 0) staged.emplace_back();
+            staged_type& entry = staged.back();
+            if constexpr (is_map_like_v<A>) {
+                if(part % 2 == 0) push_decode<key_type, Meta>(decoder, &entry.first);
+                else push_decode<typename A::mapped_type, Meta>(decoder, &entry.second);
+            }
+            else {
+                push_decode<key_type, Meta>(decoder, &entry);
+            }
+            return step_result::descend;
+        }
+
+        A* value = static_cast<A*>(frame.Target);
+        value->clear();
+        reserve_entries(*value, staged.size());
+        for(staged_type& entry : staged) {
+            if constexpr (is_map_like_v<A>) emplace_entry(*value, std::move(entry.first))->second = std::move(entry.second);
+            else emplace_entry(*value, std::move(entry));
+        }
+        frame.Staging.reset();
+        return step_result::finished;
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>, incremental_decoder::step_result>
+    decode_step(incremental_decoder& decoder, incremental_decoder::frame& frame) {
+        using step_result = incremental_decoder::step_result;
+
+        if(frame.Index == 1) return step_result::finished;
+        if(!decoder.take(&frame.Scratch, sizeof(uint8_t), frame.Filled)) return step_result::need_more;
+        frame.Index = 1;
+
+        O* value = static_cast<O*>(frame.Target);
+        if(frame.Scratch == 0) {
+            value->reset();
+            return step_result::finished;
+        }
+        push_decode<typename O::value_type, Meta>(decoder, &value->emplace());
+        return step_result::descend;
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>, incremental_decoder::step_result>
+    decode_step(incremental_decoder& decoder, incremental_decoder::frame& frame) {
+        using step_result = incremental_decoder::step_result;
+        using table = variant_table<V>;
+
+        if(frame.Index == 1) return step_result::finished;
+        if(!decoder.take(&frame.Scratch, sizeof(variant_tag_t<V>), frame.Filled)) return step_result::need_more;
+        frame.Index = 1;
+
+        const size_t tag = static_cast<size_t>(frame.Scratch);
+        if(tag > table::count) return step_result::failed;
+        if(tag == table::count) return step_result::finished;
+        table::types[tag]->actions().PushDecode(decoder, table::emplacers[tag](frame.Target));
+        return step_result::descend;
+    }
+
+    // Goes through a call, instead of taking the address of decode_step, so overloads declared
+    // after this header are also found
+    template <typename T, typename Meta = meta_type>
+    incremental_decoder::step_result decode_frame(incremental_decoder& decoder, incremental_decoder::frame& frame) {
+        return decode_step<T, Meta>(decoder, frame);
+    }
+
+    template <typename T, typename Meta>
+    std::enable_if_t<is_serializable_v<T>>
+    push_decode(incremental_decoder& decoder, void *to) { decoder.push(&decode_frame<T, Meta>, to); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>>
+    push_decode(incremental_decoder& decoder, void *to) {}
+
+    template <typename T>
+    std::enable_if_t<is_serializable_v<T>>
+    incremental_decoder::reset(T& target, decode_limits limits) {
+        m_stack.clear();
+        m_limits = limits;
+        m_allocationLeft = limits.MaxAllocation;
+        m_failed = false;
+        m_consumed = 0;
+        push_decode<T>(*this, &target);
+    }
+
+    // ========================================================================-------
+    // ======= Validated Decoding
+    // ========================================================================-------
+
+    // Lower bound of the bytes a value of T takes on the wire. Fields that can't be resolved at
+    // compile time (containers inside classes) count as 0, which keeps it a lower bound.
+    template <typename T>
+    constexpr size_t min_wire_size();
+
+    template <typename C, size_t I>
+    constexpr size_t min_field_wire_size() {
+        using field_type = reflected_field_t<C, I>;
+        constexpr mmfield field = mmclass_storage<C>::Fields[I];
+        if constexpr (is_hashed_type_v<field_type>) return min_wire_size<field_type>();
+        else return is_fundamental_hash(field.hash()) ? field.type().size() : 0;
+    }
+
+    template <typename C, size_t... I>
+    constexpr size_t min_fields_wire_size(std::index_sequence<I...>) {
+        return (min_field_wire_size<C, I>() + ... + 0);
+    }
+
+    template <typename T>
+    constexpr size_t min_wire_size() {
+        if constexpr (std::is_fundamental_v<T>) return sizeof(T);
+        else if constexpr (is_hashed_type_v<T>) return sizeof(hash_type) + presence_size<T>() + min_fields_wire_size<T>(std::make_index_sequence<mmclass_storage<T>::field_count()>());
+        else if constexpr (is_fixed_array_v<T>) return is_fixed_array<T>::size * min_wire_size<typename is_fixed_array<T>::value_type>();
+        else if constexpr (is_optional_v<T>) return sizeof(uint8_t);
+        else if constexpr (is_variant_v<T>) return sizeof(variant_tag_t<T>);
+        else return sizeof(size_t);
+    }
+
+    template <typename A>
+    constexpr size_t min_entry_wire_size() {
+        if constexpr (is_map_like_v<A>) return min_wire_size<typename A::key_type>() + min_wire_size<typename A::mapped_type>();
+        else return min_wire_size<typename A::key_type>();
+    }
+
+    // What one entry costs the allocation budget: node-based containers allocate the value plus at least two
+    // links per entry, hashed ones also keep about one bucket pointer per entry
+    template <typename A>
+    constexpr size_t entry_allocation_size() {
+        constexpr size_t nodeSize = sizeof(typename A::value_type) + 2 * sizeof(void*);
+        if constexpr (is_unordered<A>::value) return nodeSize + sizeof(void*);
+        else return nodeSize;
+    }
+
+    enum class decode_error {
+        none,
+        truncated,              // Input ended before the value did
+        version_mismatch,
+        length_exceeds_input,   // A length prefix claims more elements than the remaining bytes could hold
+        allocation_limit,
+        depth_limit,
+        invalid_tag,            // Optional presence or variant tag out of range
+        length_mismatch         // A value didn't take up the bytes its length prefix claimed
+    };
+
+    // Reads the binary format from memory, checking every length against the bytes that are left
+    // and against the limits. Stops at the first error instead of asserting.
+    class validating_reader {
+    public:
+        validating_reader(const binary_buffer_type *data, size_t size, decode_limits limits = {}) :
+            m_begin(data),
+            m_input(data),
+            m_end(data + size),
+            m_allocationLeft(limits.MaxAllocation),
+            m_depthLeft(limits.MaxDepth) {}
+
+        decode_error error() const { return m_error; }
+        size_t consumed() const { return static_cast<size_t>(m_input - m_begin); }
+        size_t remaining() const { return static_cast<size_t>(m_end - m_input); }
+
+        bool take(void *to, size_t size) {
+            if(size > remaining()) return fail(decode_error::truncated);
+            if(size > 0) memcpy(to, m_input, size);
+            m_input += size;
+            return true;
+        }
+
+        bool skip(size_t size) {
+            if(size > remaining()) return fail(decode_error::truncated);
+            m_input += size;
+            return true;
+        }
+
+        // Whether 'count' elements fit in the rest of the input and in the allocation budget. Elements that
+        // take no bytes on the wire (std::array<T, 0>) are only bounded by the budget.
+        bool reserve(size_t count, size_t minWireSize, size_t elementSize) {
+            const size_t byInput = minWireSize > 0 ? remaining() / minWireSize : SIZE_MAX;
+            const size_t byBudget = m_allocationLeft / elementSize;
+            if(count > (byInput < byBudget ? byInput : byBudget)) {
+                return fail(count > byInput ? decode_error::length_exceeds_input : decode_error::allocation_limit);
+            }
+            m_allocationLeft -= count * elementSize;
+            return true;
+        }
+
+        template <typename T>
+        bool reserve(size_t count) { return reserve(count, min_wire_size<T>(), sizeof(T)); }
+
+        // Only counts levels that were entered, callers that fail here don't leave()
+        bool enter() {
+            if(m_depthLeft == 0) return fail(decode_error::depth_limit);
+            m_depthLeft--;
+            return true;
+        }
+        void leave() { m_depthLeft++; }
+
+        bool fail(decode_error error) {
+            if(m_error == decode_error::none) m_error = error;
+            return false;
+        }
+
+    private:
+        const binary_buffer_type *m_begin;
+        const binary_buffer_type *m_input;
+        const binary_buffer_type *m_end;
+        size_t m_allocationLeft;
+        size_t m_depthLeft;
+        decode_error m_error = decode_error::none;
+    };
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, bool>
+    read_validated(const mmfield* fieldMeta, validating_reader& from, void *to) { return read_validated_serializable<T>(fieldMeta, from, to); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>, bool>
+    read_validated(const mmfield* fieldMeta, validating_reader& from, void *to) { return true; }
+
+    template <typename P, typename Meta = meta_type>
+    std::enable_if_t<std::is_fundamental_v<P>, bool>
+    read_validated_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        return from.take(to, sizeof(P));
+    }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>, bool>
+    read_validated_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        hash_type version;
+        if(!from.take(&version, sizeof(version))) return false;
+        if(version != classmeta_v<C>.version()) return from.fail(decode_error::version_mismatch);
+
+        presence_bits<C> presence{};
+        if(!from.take(presence.data(), presence.size()) || !from.enter()) return false;
+
+        bool ok = true;
+        size_t optionalIndex = 0;
+        for_each_field<C>([&](const mmfield& field) {
+            if(!ok) return;
+            void *fieldValue = field.get_pointer_from(to);
+            if(const optional_actions* optional = field.type().actions().Optional) {
+                if(has_presence(presence.data(), optionalIndex++)) ok = optional->ValueType->actions().ValidatedRead(&field, from, optional->Emplace(fieldValue));
+                else optional->Reset(fieldValue);
+            }
+            else {
+                ok = field.type().actions().ValidatedRead(&field, from, fieldValue);
+            }
+        });
+        from.leave();
+        return ok;
+    }
+
+    template <typename D, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<D> || is_string_v<D>, bool>
+    read_validated_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        using arr_size_type = typename D::size_type;
+        using arr_value_type = typename D::value_type;
+
+        arr_size_type size = 0;
+        if(!from.take(&size, sizeof(size)) || !from.reserve<arr_value_type>(size)) return false;
+
+        D* value = static_cast<D*>(to);
+        value->resize(size);
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            return from.take(value->data(), size * sizeof(arr_value_type));
+        }
+        else {
+            if(!from.enter()) return false;
+            bool ok = true;
+            for(arr_size_type i = 0; ok && i < size; i++) {
+                ok = read_validated<arr_value_type, Meta>(fieldMeta, from, value->data() + i);
+            }
+            from.leave();
+            return ok;
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>, bool>
+    read_validated_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+        constexpr size_t elementCount = is_fixed_array<A>::size;
+
+        arr_value_type* elements = std::data(*static_cast<A*>(to));
+        if constexpr (std::is_fundamental_v<arr_value_type>) {
+            return from.take(elements, elementCount * sizeof(arr_value_type));
+        }
+        else {
+            if(!from.enter()) return false;
+            bool ok = true;
+            for(size_t i = 0; ok && i < elementCount; i++) {
+                ok = read_validated<arr_value_type, Meta>(fieldMeta, from, elements + i);
+            }
+            from.leave();
+            return ok;
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>, bool>
+    read_validated_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        using arr_size_type = typename A::size_type;
+        using key_type = typename A::key_type;
+
+        arr_size_type size = 0;
+        if(!from.take(&size, sizeof(size)) || !from.reserve(size, min_entry_wire_size<A>(), entry_allocation_size<A>())) return false;
+        if(!from.enter()) return false;
+
+        A* value = static_cast<A*>(to);
+        value->clear();
+        reserve_entries(*value, size);
+        bool ok = true;
+        for(arr_size_type i = 0; ok && i < size; i++) {
+            key_type key{};
+            ok = read_validated<key_type, Meta>(fieldMeta, from, &key);
+            if(!ok) break;
+            auto entry = emplace_entry(*value, std::move(key));
+            if constexpr (is_map_like_v<A>) {
+                ok = read_validated<typename A::mapped_type, Meta>(fieldMeta, from, &entry->second);
+            }
+        }
+        from.leave();
+        return ok;
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>, bool>
+    read_validated_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        uint8_t present = 0;
+        if(!from.take(&present, sizeof(present))) return false;
+        if(present > 1) return from.fail(decode_error::invalid_tag);
+
+        O* value = static_cast<O*>(to);
+        if(!present) {
+            value->reset();
+            return true;
+        }
+        return read_validated<typename O::value_type, Meta>(fieldMeta, from, &value->emplace());
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>, bool>
+    read_validated_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        using table = variant_table<V>;
+
+        variant_tag_t<V> tag = 0;
+        if(!from.take(&tag, sizeof(tag))) return false;
+        if(tag > table::count) return from.fail(decode_error::invalid_tag);
+        if(tag == table::count) return true;
+        return table::types[tag]->actions().ValidatedRead(fieldMeta, from, table::emplacers[tag](to));
+    }
+
+    // Decodes 'value' from untrusted memory. On error 'value' may be partially written.
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, decode_error>
+    deserialize_validated(const binary_buffer_type *data, size_t size, T& value, decode_limits limits = {}) {
+        validating_reader from { data, size, limits };
+        read_validated<T, Meta>(nullptr, from, &value);
+        return from.error();
+    }
+
+    // ========================================================================-------
+    // ======= Evolvable Serialization
+    // ========================================================================-------
+
+    // Same as the binary format, except for classes: their fields are tagged with a hash of their
+    // name and classes are prefixed by their byte length. Readers match fields by tag, so data
+    // written before fields were added, removed or reordered can still be read. Unknown fields
+    // are skipped, and fields missing from the data keep the value they had.
+    //
+    // Class: [body size: u32] then per field [tag: u32][payload size: u32, only if length-prefixed][payload]
+    // The low 3 bits of a tag are the payload size class (1 << n bytes), or 7 when it's length-prefixed.
+    // Changing the type of a field to one of another size makes it unknown to older readers,
+    // any other type change needs the field to be renamed.
+
+    static constexpr uint32_t kLengthPrefixedTag = 7;
+
+    constexpr uint32_t evolvable_tag(const mmfield& field) {
+        uint32_t sizeClass = kLengthPrefixedTag;
+        if(!field.type().actions().IsOptional && is_fundamental_hash(field.hash())) {
+            for(uint32_t n = 0; n < 5; n++) {
+                if(field.type().size() == (size_t(1) << n)) sizeClass = n;
+            }
+        }
+        return (static_cast<uint32_t>(utils::hash_bytes(field.name())) & ~kLengthPrefixedTag) | sizeClass;
+    }
+
+    template <typename C, size_t... I>
+    constexpr std::array<uint32_t, sizeof...(I)> make_evolvable_tags(std::index_sequence<I...>) {
+        return { evolvable_tag(mmclass_storage<C>::Fields[I])... };
+    }
+
+    template <typename C>
+    inline constexpr auto evolvable_tags_v = make_evolvable_tags<C>(std::make_index_sequence<mmclass_storage<C>::field_count()>());
+
+    template <typename C>
+    constexpr bool has_unique_evolvable_tags() {
+        constexpr auto& tags = evolvable_tags_v<C>;
+        for(size_t i = 0; i < tags.size(); i++) {
+            for(size_t j = i + 1; j < tags.size(); j++) {
+                if((tags[i] >> 3) == (tags[j] >> 3)) return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename C>
+    size_t find_evolvable_field(uint32_t tag) {
+        constexpr auto& tags = evolvable_tags_v<C>;
+        for(size_t i = 0; i < tags.size(); i++) {
+            if(tags[i] == tag) return i;
+        }
+        return invalid_field_index;
+    }
+
+    template <typename T>
+    constexpr size_t min_evolvable_wire_size() {
+        if constexpr (!contains_class_v<T>) return min_wire_size<T>();
+        else if constexpr (is_hashed_type_v<T>) return sizeof(uint32_t);
+        else if constexpr (is_fixed_array_v<T>) return is_fixed_array<T>::size * min_evolvable_wire_size<typename is_fixed_array<T>::value_type>();
+        else return min_wire_size<T>();
+    }
+
+    // Writes a placeholder for a u32 length, returns where its payload starts
+    inline size_t begin_length_prefix(memory_buffer_write& to) {
+        const uint32_t placeholder = 0;
+        to.write(reinterpret_cast<const binary_buffer_type*>(&placeholder), sizeof(placeholder));
+        return to.size();
+    }
+
+    inline void end_length_prefix(memory_buffer_write& to, size_t payloadStart) {
+        assert(to.size() - payloadStart <= UINT32_MAX && "Evolvable payloads are limited to 4 GiB.");
+        const uint32_t length = static_cast<uint32_t>(to.size() - payloadStart);
+        memcpy(to.data() + payloadStart - sizeof(length), &length, sizeof(length));
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>>
+    write_evolvable(const mmfield* container, const void *from, memory_buffer_write& to) { write_evolvable_serializable<T>(container, from, to); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>>
+    write_evolvable(const mmfield* container, const void *from, memory_buffer_write& to) {}
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, bool>
+    read_evolvable(const mmfield* fieldMeta, validating_reader& from, void *to) { return read_evolvable_serializable<T>(fieldMeta, from, to); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>, bool>
+    read_evolvable(const mmfield* fieldMeta, validating_reader& from, void *to) { return true; }
+
+    // Without classes inside there's nothing to evolve, so the binary format is used as is
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!contains_class_v<T>>
+    write_evolvable_serializable(const mmfield* container, const void *from, memory_buffer_write& to) {
+        write<T, Meta>(container, from, to);
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!contains_class_v<T>, bool>
+    read_evolvable_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        return read_validated<T, Meta>(fieldMeta, from, to);
+    }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>>
+    write_evolvable_serializable(const mmfield* container, const void *from, memory_buffer_write& to) {
+        static_assert(has_unique_evolvable_tags<C>(), "Two field names of the class hash to the same evolvable tag, rename one of them.");
+        constexpr auto& tags = evolvable_tags_v<C>;
+
+        const size_t bodyStart = begin_length_prefix(to);
+        size_t fieldIndex = 0;
+        for_each_field<C>([&](const mmfield& field) {
+            const uint32_t tag = tags[fieldIndex++];
+            const void *fieldValue = field.get_pointer_from(from);
+            const optional_actions* optional = field.type().actions().Optional;
+            if(optional) {
+                // Empty optionals are left out, readers reset the ones they don't find
+                fieldValue = optional->Find(fieldValue);
+                if(!fieldValue) return;
+            }
+
+            to.write(reinterpret_cast<const binary_buffer_type*>(&tag), sizeof(tag));
+            if((tag & kLengthPrefixedTag) != kLengthPrefixedTag) {
+                field.type().actions().Write(&field, fieldValue, to);
+                return;
+            }
+
+            const size_t payloadStart = begin_length_prefix(to);
+            if(optional) optional->ValueType->actions().WriteEvolvable(&field, fieldValue, to);
+            else field.type().actions().WriteEvolvable(&field, fieldValue, to);
+            end_length_prefix(to, payloadStart);
+        });
+        end_length_prefix(to, bodyStart);
+    }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>, bool>
+    read_evolvable_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        static_assert(has_unique_evolvable_tags<C>(), "Two field names of the class hash to the same evolvable tag, rename one of them.");
+        constexpr auto& tags = evolvable_tags_v<C>;
+
+        uint32_t bodySize = 0;
+        if(!from.take(&bodySize, sizeof(bodySize))) return false;
+        if(bodySize > from.remaining()) return from.fail(decode_error::length_exceeds_input);
+        if(!from.enter()) return false;
+
+        if constexpr (optional_field_count<C>() > 0) {
+            for_each_field<C>([&](const mmfield& field) {
+                if(const optional_actions* optional = field.type().actions().Optional) optional->Reset(field.get_pointer_from(to));
+            });
+        }
+
+        const fieldseq fields = classmeta_v<C>.fields();
+        const size_t bodyEnd = from.consumed() + bodySize;
+        size_t nextField = 0;
+        bool ok = true;
+        while(ok && from.consumed() < bodyEnd) {
+            uint32_t tag = 0;
+            uint32_t payloadSize = 0;
+            if(!from.take(&tag, sizeof(tag))) break;
+            if((tag & kLengthPrefixedTag) == kLengthPrefixedTag) {
+                if(!from.take(&payloadSize, sizeof(payloadSize))) break;
+            }
+            else {
+                payloadSize = uint32_t(1) << (tag & kLengthPrefixedTag);
+            }
+
+            const size_t payloadEnd = from.consumed() + payloadSize;
+            if(payloadEnd > bodyEnd) {
+                ok = from.fail(decode_error::length_exceeds_input);
+                break;
+            }
+
+            // Fields are usually stored in declaration order, so the next one is tried before searching
+            const size_t index = nextField < tags.size() && tags[nextField] == tag ? nextField : find_evolvable_field<C>(tag);
+            if(index == invalid_field_index) {
+                ok = from.skip(payloadSize);
+                continue;
+            }
+            nextField = index + 1;
+
+            const mmfield& field = fields.begin()[index];
+            void *fieldValue = field.get_pointer_from(to);
+            if(const optional_actions* optional = field.type().actions().Optional) {
+                ok = optional->ValueType->actions().ReadEvolvable(&field, from, optional->Emplace(fieldValue));
+            }
+            else {
+                ok = field.type().actions().ReadEvolvable(&field, from, fieldValue);
+            }
+            if(ok && from.consumed() != payloadEnd) ok = from.fail(decode_error::length_mismatch);
+        }
+        from.leave();
+        return ok && (from.consumed() == bodyEnd || from.fail(decode_error::length_mismatch));
+    }
+
+    template <typename D, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<D> && contains_class_v<D>>
+    write_evolvable_serializable(const mmfield* container, const void *from, memory_buffer_write& to) {
+        const D* value = static_cast<const D*>(from);
+        const typename D::size_type size = value->size();
+        write<typename D::size_type>(container, &size, to);
+        for(const auto& element : *value) {
+            write_evolvable<typename D::value_type, Meta>(container, &element, to);
+        }
+    }
+
+    template <typename D, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<D> && contains_class_v<D>, bool>
+    read_evolvable_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        using arr_size_type = typename D::size_type;
+        using arr_value_type = typename D::value_type;
+
+        arr_size_type size = 0;
+        if(!from.take(&size, sizeof(size))) return false;
+        if(!from.reserve(size, min_evolvable_wire_size<arr_value_type>(), sizeof(arr_value_type)) || !from.enter()) return false;
+
+        D* value = static_cast<D*>(to);
+        value->resize(size);
+        bool ok = true;
+        for(arr_size_type i = 0; ok && i < size; i++) {
+            ok = read_evolvable<arr_value_type, Meta>(fieldMeta, from, value->data() + i);
+        }
+        from.leave();
+        return ok;
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A> && contains_class_v<A>>
+    write_evolvable_serializable(const mmfield* container, const void *from, memory_buffer_write& to) {
+        for(const auto& element : *static_cast<const A*>(from)) {
+            write_evolvable<typename is_fixed_array<A>::value_type, Meta>(container, &element, to);
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A> && contains_class_v<A>, bool>
+    read_evolvable_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        if(!from.enter()) return false;
+        bool ok = true;
+        for(auto& element : *static_cast<A*>(to)) {
+            ok = ok && read_evolvable<typename is_fixed_array<A>::value_type, Meta>(fieldMeta, from, &element);
+        }
+        from.leave();
+        return ok;
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A> && contains_class_v<A>>
+    write_evolvable_serializable(const mmfield* container, const void *from, memory_buffer_write& to) {
+        const A* value = static_cast<const A*>(from);
+        const typename A::size_type size = value->size();
+        write<typename A::size_type>(container, &size, to);
+        for(const auto& entry : *value) {
+            write_evolvable<typename A::key_type, Meta>(container, &entry_key<A>(entry), to);
+            if constexpr (is_map_like_v<A>) {
+                write_evolvable<typename A::mapped_type, Meta>(container, &entry.second, to);
+            }
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A> && contains_class_v<A>, bool>
+    read_evolvable_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        using arr_size_type = typename A::size_type;
+        using key_type = typename A::key_type;
+
+        size_t minEntrySize = min_evolvable_wire_size<key_type>();
+        if constexpr (is_map_like_v<A>) minEntrySize += min_evolvable_wire_size<typename A::mapped_type>();
+
+        arr_size_type size = 0;
+        if(!from.take(&size, sizeof(size)) || !from.reserve(size, minEntrySize, entry_allocation_size<A>())) return false;
+        if(!from.enter()) return false;
+
+        A* value = static_cast<A*>(to);
+        value->clear();
+        reserve_entries(*value, size);
+        bool ok = true;
+        for(arr_size_type i = 0; ok && i < size; i++) {
+            key_type key{};
+            ok = read_evolvable<key_type, Meta>(fieldMeta, from, &key);
+            if(!ok) break;
+            auto entry = emplace_entry(*value, std::move(key));
+            if constexpr (is_map_like_v<A>) {
+                ok = read_evolvable<typename A::mapped_type, Meta>(fieldMeta, from, &entry->second);
+            }
+        }
+        from.leave();
+        return ok;
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O> && contains_class_v<O>>
+    write_evolvable_serializable(const mmfield* container, const void *from, memory_buffer_write& to) {
+        const O* value = static_cast<const O*>(from);
+        const uint8_t present = value->has_value();
+        write<uint8_t>(container, &present, to);
+        if(present) {
+            write_evolvable<typename O::value_type, Meta>(container, &**value, to);
+        }
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O> && contains_class_v<O>, bool>
+    read_evolvable_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        uint8_t present = 0;
+        if(!from.take(&present, sizeof(present))) return false;
+        if(present > 1) return from.fail(decode_error::invalid_tag);
+
+        O* value = static_cast<O*>(to);
+        if(!present) {
+            value->reset();
+            return true;
+        }
+        return read_evolvable<typename O::value_type, Meta>(fieldMeta, from, &value->emplace());
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V> && contains_class_v<V>>
+    write_evolvable_serializable(const mmfield* container, const void *from, memory_buffer_write& to) {
+        using table = variant_table<V>;
+
+        const variant_tag_t<V> tag = table::tag_of(*static_cast<const V*>(from));
+        write<variant_tag_t<V>>(container, &tag, to);
+        if(tag < table::count) {
+            table::types[tag]->actions().WriteEvolvable(container, table::getters[tag](from), to);
+        }
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V> && contains_class_v<V>, bool>
+    read_evolvable_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        using table = variant_table<V>;
+
+        variant_tag_t<V> tag = 0;
+        if(!from.take(&tag, sizeof(tag))) return false;
+        if(tag > table::count) return from.fail(decode_error::invalid_tag);
+        if(tag == table::count) return true;
+        return table::types[tag]->actions().ReadEvolvable(fieldMeta, from, table::emplacers[tag](to));
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>>
+    serialize_evolvable(const T& value, memory_buffer_write& to) {
+        write_evolvable<T, Meta>(nullptr, &value, to);
+    }
+
+    // Length prefixes are patched once their payload is known, so the value is built in memory first
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>>
+    serialize_evolvable(const T& value, binary_buffer_write& to) {
+        memory_buffer_write buffer;
+        write_evolvable<T, Meta>(nullptr, &value, buffer);
+        to.write(buffer.data(), buffer.size());
+    }
+
+    // Input is checked like deserialize_validated. On error 'value' may be partially written.
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, decode_error>
+    deserialize_evolvable(const binary_buffer_type *data, size_t size, T& value, decode_limits limits = {}) {
+        validating_reader from { data, size, limits };
+        read_evolvable<T, Meta>(nullptr, from, &value);
+        return from.error();
+    }
+
+    // ========================================================================-------
+    // ======= Equality, Hashing and Copy
+    // ========================================================================-------
+
+    // Everything serialization sees takes part, so values that serialize the same are equal.
+    // Fundamentals compare bitwise: NaNs with the same payload are equal, and -0.0 isn't equal to 0.0,
+    // which keeps equal values hashing the same.
+
+    inline uint64_t hash_mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDull;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    inline size_t hash_combine(size_t seed, uint64_t value) {
+        return static_cast<size_t>(hash_mix(seed ^ (value + 0x9E3779B97F4A7C15ull + (uint64_t(seed) << 6) + (uint64_t(seed) >> 2))));
+    }
+
+    // 4 independent lanes over 32 bytes per iteration, so long runs aren't bound by multiply latency
+    inline size_t hash_memory(const void *data, size_t size, size_t seed) {
+        constexpr uint64_t kMultiplier = 0x9FB21C651E98DF25ull;
+        const uint8_t *bytes = static_cast<const uint8_t*>(data);
+        uint64_t h = seed ^ (size * 0x9E3779B97F4A7C15ull);
+
+        if(size >= 32) {
+            uint64_t lanes[4] = { h, h + kMultiplier, h ^ 0xC4CEB9FE1A85EC53ull, h - kMultiplier };
+            for(; size >= 32; size -= 32, bytes += 32) {
+                for(int lane = 0; lane < 4; lane++) {
+                    uint64_t word;
+                    memcpy(&word, bytes + lane * 8, sizeof(word));
+                    lanes[lane] = (lanes[lane] ^ word) * kMultiplier;
+                    lanes[lane] ^= lanes[lane] >> 29;
+                }
+            }
+            h = hash_mix(lanes[0]) ^ hash_mix(lanes[1] + 1) ^ hash_mix(lanes[2] + 2) ^ hash_mix(lanes[3] + 3);
+        }
+        for(; size >= 8; size -= 8, bytes += 8) {
+            uint64_t word;
+            memcpy(&word, bytes, sizeof(word));
+            h = (h ^ word) * kMultiplier;
+            h ^= h >> 29;
+        }
+        if(size > 0) {
+            uint64_t tail = 0;
+            memcpy(&tail, bytes, size);
+            h = (h ^ tail) * kMultiplier;
+        }
+        return static_cast<size_t>(hash_mix(h));
+    }
+
+    // long double has padding bytes inside its storage, so it can't be compared as memory
+    template <typename T>
+    inline constexpr bool is_bitwise_v = std::is_fundamental_v<T> && !std::is_same_v<T, long double>;
+
+    constexpr bool is_bitwise_hash(hash_type hash) {
+        return is_fundamental_hash(hash) && !matches_any_hash<long double>(hash);
+    }
+
+    // Adjacent bitwise fields without padding between them, handled as a single block of memory
+    struct field_run {
+        size_t Offset;
+        size_t Size;
+        size_t First;           // Index of the first field
+        bool Bitwise;           // Otherwise it's a single field handled by its own actions
+    };
+
+    template <typename C>
+    struct field_runs {
+        std::array<field_run, mmclass_storage<C>::field_count()> Runs{};
+        size_t Count = 0;
+    };
+
+    template <typename C>
+    constexpr field_runs<C> make_field_runs() {
+        field_runs<C> result{};
+        for(size_t i = 0; i < mmclass_storage<C>::field_count(); i++) {
+            const mmfield& field = mmclass_storage<C>::Fields[i];
+            const bool bitwise = is_bitwise_hash(field.hash());
+            if(result.Count > 0) {
+                field_run& last = result.Runs[result.Count - 1];
+                if(bitwise && last.Bitwise && last.Offset + last.Size == field.offset()) {
+                    last.Size += field.type().size();
+                    continue;
+                }
+            }
+            result.Runs[result.Count++] = { field.offset(), field.type().size(), i, bitwise };
+        }
+        return result;
+    }
+
+    template <typename C>
+    inline constexpr field_runs<C> field_runs_v = make_field_runs<C>();
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, bool>
+    equal_at(const mmfield* container, const void *a, const void *b) { return equal_serializable<T>(container, a, b); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>, bool>
+    equal_at(const mmfield* container, const void *a, const void *b) { return true; }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, size_t>
+    hash_at(const mmfield* container, const void *from, size_t seed) { return hash_serializable<T>(container, from, seed); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>, size_t>
+    hash_at(const mmfield* container, const void *from, size_t seed) { return seed; }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>>
+    copy_at(const mmfield* container, const void *from, void *to) { copy_serializable<T>(container, from, to); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>>
+    copy_at(const mmfield* container, const void *from, void *to) {}
+
+    // Fundamentals
+    template <typename P, typename Meta = meta_type>
+    std::enable_if_t<std::is_fundamental_v<P>, bool>
+    equal_serializable(const mmfield* container, const void *a, const void *b) {
+        if constexpr (is_bitwise_v<P>) return memcmp(a, b, sizeof(P)) == 0;
+        else return *static_cast<const P*>(a) == *static_cast<const P*>(b);
+    }
+
+    template <typename P, typename Meta = meta_type>
+    std::enable_if_t<std::is_fundamental_v<P>, size_t>
+    hash_serializable(const mmfield* container, const void *from, size_t seed) {
+        if constexpr (is_bitwise_v<P>) return hash_memory(from, sizeof(P), seed);
+        else return hash_combine(seed, std::hash<P>()(*static_cast<const P*>(from)));
+    }
+
+    // Classes, runs of bitwise fields are compared, hashed and copied as memory
+    template <typename C, size_t I>
+    bool equal_run(const void *a, const void *b) {
+        constexpr field_run run = field_runs_v<C>.Runs[I];
+        if constexpr (run.Bitwise) {
+            return memcmp(static_cast<const binary_buffer_type*>(a) + run.Offset, static_cast<const binary_buffer_type*>(b) + run.Offset, run.Size) == 0;
+        }
+        else {
+            const mmfield& field = mmclass_storage<C>::Fields[run.First];
+            return field.type().actions().Equal(&field, field.get_pointer_from(a), field.get_pointer_from(b));
+        }
+    }
+
+    template <typename C, size_t I>
+    size_t hash_run(const void *from, size_t seed) {
+        constexpr field_run run = field_runs_v<C>.Runs[I];
+        if constexpr (run.Bitwise) {
+            return hash_memory(static_cast<const binary_buffer_type*>(from) + run.Offset, run.Size, seed);
+        }
+        else {
+            const mmfield& field = mmclass_storage<C>::Fields[run.First];
+            return field.type().actions().Hash(&field, field.get_pointer_from(from), seed);
+        }
+    }
+
+    template <typename C, size_t I>
+    void copy_run(const void *from, void *to) {
+        constexpr field_run run = field_runs_v<C>.Runs[I];
+        if constexpr (run.Bitwise) {
+            memcpy(static_cast<binary_buffer_type*>(to) + run.Offset, static_cast<const binary_buffer_type*>(from) + run.Offset, run.Size);
+        }
+        else {
+            const mmfield& field = mmclass_storage<C>::Fields[run.First];
+            field.type().actions().Copy(&field, field.get_pointer_from(from), field.get_pointer_from(to));
+        }
+    }
+
+    template <typename C, size_t... I>
+    bool equal_runs(const void *a, const void *b, std::index_sequence<I...>) { return (equal_run<C, I>(a, b) && ...); }
+
+    template <typename C, size_t... I>
+    size_t hash_runs(const void *from, size_t seed, std::index_sequence<I...>) {
+        ((seed = hash_run<C, I>(from, seed)), ...);
+        return seed;
+    }
+
+    template <typename C, size_t... I>
+    void copy_runs(const void *from, void *to, std::index_sequence<I...>) { (copy_run<C, I>(from, to), ...); }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>, bool>
+    equal_serializable(const mmfield* container, const void *a, const void *b) {
+        return equal_runs<C>(a, b, std::make_index_sequence<field_runs_v<C>.Count>());
+    }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>, size_t>
+    hash_serializable(const mmfield* container, const void *from, size_t seed) {
+        return hash_runs<C>(from, seed, std::make_index_sequence<field_runs_v<C>.Count>());
+    }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>>
+    copy_serializable(const mmfield* container, const void *from, void *to) {
+        copy_runs<C>(from, to, std::make_index_sequence<field_runs_v<C>.Count>());
+    }
+
+    // Vectors and strings
+    template <typename D, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<D> || is_string_v<D>, bool>
+    equal_serializable(const mmfield* container, const void *a, const void *b) {
+        using arr_value_type = typename D::value_type;
+
+        const D& left = *static_cast<const D*>(a);
+        const D& right = *static_cast<const D*>(b);
+        if(left.size() != right.size()) return false;
+        if constexpr (is_bitwise_v<arr_value_type>) {
+            return left.empty() || memcmp(left.data(), right.data(), left.size() * sizeof(arr_value_type)) == 0;
+        }
+        else {
+            for(size_t i = 0; i < left.size(); i++) {
+                if(!equal_at<arr_value_type, Meta>(container, left.data() + i, right.data() + i)) return false;
+            }
+            return true;
+        }
+    }
+
+    template <typename D, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<D> || is_string_v<D>, size_t>
+    hash_serializable(const mmfield* container, const void *from, size_t seed) {
+        using arr_value_type = typename D::value_type;
+
+        const D& value = *static_cast<const D*>(from);
+        if constexpr (is_bitwise_v<arr_value_type>) {
+            return hash_memory(value.data(), value.size() * sizeof(arr_value_type), seed);
+        }
+        else {
+            seed = hash_combine(seed, value.size());
+            for(const arr_value_type& element : value) {
+                seed = hash_at<arr_value_type, Meta>(container, &element, seed);
+            }
+            return seed;
+        }
+    }
+
+    // Without reflected classes inside, assignment already copies everything serialization sees
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!contains_class_v<T> && !std::is_array_v<T> && std::is_copy_assignable_v<T>>
+    copy_serializable(const mmfield* container, const void *from, void *to) {
+        *static_cast<T*>(to) = *static_cast<const T*>(from);
+    }
+
+    template <typename D, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<D> && contains_class_v<D>>
+    copy_serializable(const mmfield* container, const void *from, void *to) {
+        const D& source = *static_cast<const D*>(from);
+        D& target = *static_cast<D*>(to);
+        target.resize(source.size());
+        for(size_t i = 0; i < source.size(); i++) {
+            copy_at<typename D::value_type, Meta>(container, source.data() + i, target.data() + i);
+        }
+    }
+
+    // Fixed-size arrays
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>, bool>
+    equal_serializable(const mmfield* container, const void *a, const void *b) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+        constexpr size_t elementCount = is_fixed_array<A>::size;
+
+        const arr_value_type *left = std::data(*static_cast<const A*>(a));
+        const arr_value_type *right = std::data(*static_cast<const A*>(b));
+        if constexpr (is_bitwise_v<arr_value_type>) {
+            return memcmp(left, right, elementCount * sizeof(arr_value_type)) == 0;
+        }
+        else {
+            for(size_t i = 0; i < elementCount; i++) {
+                if(!equal_at<arr_value_type, Meta>(container, left + i, right + i)) return false;
+            }
+            return true;
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>, size_t>
+    hash_serializable(const mmfield* container, const void *from, size_t seed) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+        constexpr size_t elementCount = is_fixed_array<A>::size;
+
+        const arr_value_type *elements = std::data(*static_cast<const A*>(from));
+        if constexpr (is_bitwise_v<arr_value_type>) {
+            return hash_memory(elements, elementCount * sizeof(arr_value_type), seed);
+        }
+        else {
+            for(size_t i = 0; i < elementCount; i++) {
+                seed = hash_at<arr_value_type, Meta>(container, elements + i, seed);
+            }
+            return seed;
+        }
+    }
+
+    // C arrays can't be assigned, so they're copied element by element like arrays of classes
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A> && (contains_class_v<A> || std::is_array_v<A>)>
+    copy_serializable(const mmfield* container, const void *from, void *to) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+
+        const arr_value_type *source = std::data(*static_cast<const A*>(from));
+        arr_value_type *target = std::data(*static_cast<A*>(to));
+        for(size_t i = 0; i < is_fixed_array<A>::size; i++) {
+            copy_at<arr_value_type, Meta>(container, source + i, target + i);
+        }
+    }
+
+    // Associative containers, unordered ones compare and hash regardless of iteration order
+    template <typename A, typename Meta = meta_type>
+    bool equal_entries(const mmfield* container, const typename A::value_type& left, const typename A::value_type& right) {
+        if(!equal_at<typename A::key_type, Meta>(container, &entry_key<A>(left), &entry_key<A>(right))) return false;
+        if constexpr (is_map_like_v<A>) return equal_at<typename A::mapped_type, Meta>(container, &left.second, &right.second);
+        else return true;
+    }
+
+    template <typename A, typename Meta = meta_type>
+    size_t hash_entry(const mmfield* container, const typename A::value_type& entry, size_t seed) {
+        seed = hash_at<typename A::key_type, Meta>(container, &entry_key<A>(entry), seed);
+        if constexpr (is_map_like_v<A>) seed = hash_at<typename A::mapped_type, Meta>(container, &entry.second, seed);
+        return seed;
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>, bool>
+    equal_serializable(const mmfield* container, const void *a, const void *b) {
+        const A& left = *static_cast<const A*>(a);
+        const A& right = *static_cast<const A*>(b);
+        if(left.size() != right.size()) return false;
+
+        auto entries_equal = [container](const auto& leftEntry, const auto& rightEntry) { return equal_entries<A, Meta>(container, leftEntry, rightEntry); };
+        if constexpr (is_unordered<A>::value) {
+            for(auto it = left.begin(); it != left.end();) {
+                const auto leftRange = left.equal_range(entry_key<A>(*it));
+                const auto rightRange = right.equal_range(entry_key<A>(*it));
+                if(!std::is_permutation(leftRange.first, leftRange.second, rightRange.first, rightRange.second, entries_equal)) return false;
+                it = leftRange.second;
+            }
+            return true;
+        }
+        else {
+            return std::equal(left.begin(), left.end(), right.begin(), entries_equal);
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>, size_t>
+    hash_serializable(const mmfield* container, const void *from, size_t seed) {
+        const A& value = *static_cast<const A*>(from);
+        seed = hash_combine(seed, value.size());
+        if constexpr (is_unordered<A>::value) {
+            size_t sum = 0;
+            for(const auto& entry : value) {
+                sum += hash_entry<A, Meta>(container, entry, 0);
+            }
+            return hash_combine(seed, sum);
+        }
+        else {
+            for(const auto& entry : value) {
+                seed = hash_entry<A, Meta>(container, entry, seed);
+            }
+            return seed;
+        }
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A> && contains_class_v<A>>
+    copy_serializable(const mmfield* container, const void *from, void *to) {
+        const A& source = *static_cast<const A*>(from);
+        A& target = *static_cast<A*>(to);
+        target.clear();
+        reserve_entries(target, source.size());
+        for(const auto& entry : source) {
+            typename A::key_type key{};
+            copy_at<typename A::key_type, Meta>(container, &entry_key<A>(entry), &key);
+            auto inserted = emplace_entry(target, std::move(key));
+            if constexpr (is_map_like_v<A>) {
+                copy_at<typename A::mapped_type, Meta>(container, &entry.second, &inserted->second);
+            }
+        }
+    }
+
+    // Optionals and variants
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>, bool>
+    equal_serializable(const mmfield* container, const void *a, const void *b) {
+        const O& left = *static_cast<const O*>(a);
+        const O& right = *static_cast<const O*>(b);
+        if(left.has_value() != right.has_value()) return false;
+        return !left.has_value() || equal_at<typename O::value_type, Meta>(container, &*left, &*right);
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>, size_t>
+    hash_serializable(const mmfield* container, const void *from, size_t seed) {
+        const O& value = *static_cast<const O*>(from);
+        seed = hash_combine(seed, value.has_value());
+        return value.has_value() ? hash_at<typename O::value_type, Meta>(container, &*value, seed) : seed;
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O> && contains_class_v<O>>
+    copy_serializable(const mmfield* container, const void *from, void *to) {
+        const O& source = *static_cast<const O*>(from);
+        O& target = *static_cast<O*>(to);
+        if(source.has_value()) copy_at<typename O::value_type, Meta>(container, &*source, &target.emplace());
+        else target.reset();
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>, bool>
+    equal_serializable(const mmfield* container, const void *a, const void *b) {
+        using table = variant_table<V>;
+
+        const variant_tag_t<V> tag = table::tag_of(*static_cast<const V*>(a));
+        if(tag != table::tag_of(*static_cast<const V*>(b))) return false;
+        return tag == table::count || table::types[tag]->actions().Equal(container, table::getters[tag](a), table::getters[tag](b));
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>, size_t>
+    hash_serializable(const mmfield* container, const void *from, size_t seed) {
+        using table = variant_table<V>;
+
+        const variant_tag_t<V> tag = table::tag_of(*static_cast<const V*>(from));
+        seed = hash_combine(seed, tag);
+        return tag < table::count ? table::types[tag]->actions().Hash(container, table::getters[tag](from), seed) : seed;
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V> && contains_class_v<V>>
+    copy_serializable(const mmfield* container, const void *from, void *to) {
+        using table = variant_table<V>;
+
+        const variant_tag_t<V> tag = table::tag_of(*static_cast<const V*>(from));
+        if(tag < table::count) {
+            table::types[tag]->actions().Copy(container, table::getters[tag](from), table::emplacers[tag](to));
+        }
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, bool>
+    equal(const T& a, const T& b) { return equal_at<T, Meta>(nullptr, &a, &b); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, size_t>
+    hash_value(const T& value, size_t seed = 0) { return hash_at<T, Meta>(nullptr, &value, seed); }
+
+    // Copies what serialization sees, anything else in 'to' is left as is
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>>
+    copy(const T& from, T& to) { copy_at<T, Meta>(nullptr, &from, &to); }
+
+    // Hash and key equality for std::unordered_map and friends
+    template <typename T>
+    struct reflected_hash {
+        size_t operator()(const T& value) const { return hash_value(value); }
+    };
+
+    template <typename T>
+    struct reflected_equal {
+        bool operator()(const T& a, const T& b) const { return mmeta::equal(a, b); }
+    };
+
+    // ========================================================================-------
+    // ======= Incremental YAML
+    // ========================================================================-------
+
+    // Applying a node leaves the value as deserialize_yaml would have left it, but only assigns what differs, so
+    // unchanged strings, vectors and entries keep their allocations. Nodes that aren't in the document are skipped,
+    // except for optionals, which are reset like deserialize_yaml does. Every overload returns whether it changed anything.
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_serializable_v<T>, bool>
+    apply_yaml_at(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) { return apply_serializable_yaml<T>(self, from, to); }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<!is_serializable_v<T>, bool>
+    apply_yaml_at(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) { return false; }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<std::is_fundamental_v<T> || is_string_v<T>, bool>
+    apply_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        if(!from.IsDefined()) return false;
+
+        T* value = static_cast<T*>(to);
+        if constexpr (is_string_v<T>) {
+            // Compared against the scalar itself and copied into the current buffer
+            if(from.IsScalar()) {
+                if(from.Scalar() == *value) return false;
+                *value = from.Scalar();
+                return true;
+            }
+        }
+
+        const T next = from.as<T>();
+        if(equal_at<T, Meta>(self, &next, value)) return false;
+        *value = next;
+        return true;
+    }
+
+    template <typename C, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<C>, bool>
+    apply_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        if(!from.IsDefined()) return false;
+
+        bool changed = false;
+        for_each_field<C>([&](const basic_mmfield<Meta>& field) {
+            changed |= field.type().actions().ApplyYAML(&field, from[field.name().data()], field.get_pointer_from(to));
+        });
+        return changed;
+    }
+
+    // Elements that were already there are applied in place, the vector only grows or shrinks at the end
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_vector_v<V>, bool>
+    apply_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        using arr_value_type = typename V::value_type;
+
+        if(!from.IsDefined()) return false;
+
+        V* value = static_cast<V*>(to);
+        const size_t kept = std::min<size_t>(value->size(), from.size());
+        bool changed = value->size() != from.size();
+        value->resize(from.size());
+
+        size_t i = 0;
+        for(auto& yamlField : from) {
+            if(i < kept) changed |= apply_yaml_at<arr_value_type, Meta>(self, yamlField, value->data() + i);
+            else read_yaml<arr_value_type>(self, yamlField, value->data() + i);
+            i++;
+        }
+        return changed;
+    }
+
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_fixed_array_v<A>, bool>
+    apply_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        using arr_value_type = typename is_fixed_array<A>::value_type;
+        constexpr size_t elementCount = is_fixed_array<A>::size;
+
+        if(!from.IsDefined()) return false;
+
+        arr_value_type* elements = std::data(*static_cast<A*>(to));
+        bool changed = false;
+        size_t i = 0;
+        for(auto& yamlField : from) {
+            if(i == elementCount) break;
+            changed |= apply_yaml_at<arr_value_type, Meta>(self, yamlField, elements + i);
+            i++;
+        }
+        return changed;
+    }
+
+    // Maps with unique keys apply values in place as long as the document has the same keys, each exactly once.
+    // Anything else is read into a new container, which only replaces the current one if they differ.
+    template <typename A, typename Meta = meta_type>
+    std::enable_if_t<is_associative_v<A>, bool>
+    apply_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        using key_type = typename A::key_type;
+
+        if(!from.IsDefined()) return false;
+
+        A* value = static_cast<A*>(to);
+        if constexpr (is_unique_map<A>::value) {
+            if(value->size() == from.size()) {
+                // Keys are all matched before anything is applied, so falling back leaves 'value' untouched
+                std::vector<typename A::iterator> entries;
+                entries.reserve(value->size());
+                for(auto yamlEntry : from) {
+                    key_type key{};
+                    if constexpr (is_yaml_map_v<A>) key = yamlEntry.first.template as<key_type>();
+                    else read_yaml<key_type>(self, yamlEntry["key"], &key);
+
+                    auto entry = value->find(key);
+                    if(entry == value->end()) break;
+                    entries.push_back(entry);
+                }
+
+                // As many matches as entries only means the same keys if no entry was matched twice
+                std::vector<const void*> matched;
+                matched.reserve(entries.size());
+                for(const auto& entry : entries) matched.push_back(&*entry);
+                std::sort(matched.begin(), matched.end(), std::less<const void*>());
+                const bool sameKeys = entries.size() == value->size() &&
+                    std::adjacent_find(matched.begin(), matched.end()) == matched.end();
+
+                if(sameKeys) {
+                    bool changed = false;
+                    size_t i = 0;
+                    for(auto yamlEntry : from) {
+                        auto& mapped = entries[i++]->second;
+                        if constexpr (is_yaml_map_v<A>) changed |= apply_yaml_at<typename A::mapped_type, Meta>(self, yamlEntry.second, &mapped);
+                        else changed |= apply_yaml_at<typename A::mapped_type, Meta>(self, yamlEntry["value"], &mapped);
+                    }
+                    return changed;
+                }
+            }
+        }
+
+        A next;
+        read_serializable_yaml<A, Meta>(self, from, &next);
+        if(equal_at<A, Meta>(self, &next, value)) return false;
+        *value = std::move(next);
+        return true;
+    }
+
+    template <typename O, typename Meta = meta_type>
+    std::enable_if_t<is_optional_v<O>, bool>
+    apply_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        O* value = static_cast<O*>(to);
+        if(!from.IsDefined() || from.IsNull()) {
+            if(!value->has_value()) return false;
+            value->reset();
+            return true;
+        }
+
+        if(value->has_value()) return apply_yaml_at<typename O::value_type, Meta>(self, from, &**value);
+        read_yaml<typename O::value_type>(self, from, &value->emplace());
+        return true;
+    }
+
+    template <typename V, typename Meta = meta_type>
+    std::enable_if_t<is_variant_v<V>, bool>
+    apply_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        using table = variant_table<V>;
+
+        if(!from.IsDefined()) return false;
+
+        const yaml_node index = from["index"];
+        if(!index.IsDefined()) return false;
+
+        const size_t tag = index.as<size_t>();
+        if(tag >= table::count) return false;
+
+        if(tag == table::tag_of(*static_cast<const V*>(to))) {
+            return table::types[tag]->actions().ApplyYAML(self, from["value"], const_cast<void*>(table::getters[tag](to)));
+        }
+        table::types[tag]->actions().ReadYAML(self, from["value"], table::emplacers[tag](to));
+        return true;
+    }
+
+    // Bit I is set when the I-th reflected field of T changed
+    template <typename T>
+    using field_mask = std::bitset<mmclass_storage<T>::field_count()>;
+
+    // Hot reload, 'onChanged' is called with every top-level field that changed, after it was assigned
+    template <typename T, typename Fn, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<T>, field_mask<T>>
+    apply_yaml(T& value, const yaml_node& from, Fn&& onChanged) {
+        field_mask<T> changed;
+        if(!from.IsDefined()) return changed;
+
+        size_t index = 0;
+        for_each_field<T>([&](const basic_mmfield<Meta>& field) {
+            if(field.type().actions().ApplyYAML(&field, from[field.name().data()], field.get_pointer_from(&value))) {
+                changed.set(index);
+                onChanged(field);
+            }
+            index++;
+        });
+        return changed;
+    }
+
+    template <typename T, typename Meta = meta_type>
+    std::enable_if_t<is_hashed_type_v<T>, field_mask<T>>
+    apply_yaml(T& value, const yaml_node& from) { return apply_yaml<T>(value, from, [](const basic_mmfield<Meta>&) {}); }
+
     template <typename T>
     constexpr basic_type_actions basic_type_actions::instantiate() {
         return {
-            &read<T>, &write<T>, &read_yaml<T>, &write_yaml<T>
+            &read<T>, &write<T>, &read_yaml<T>, &write_yaml<T>, &apply_yaml_at<T>, &read_column<T>, &write_column<T>, &push_decode<T>,
+            &binary_size<T>, &read_validated<T>, &write_evolvable<T>, &read_evolvable<T>,
+            &equal_at<T>, &hash_at<T>, &copy_at<T>, optional_actions_v<T>, has_optional_actions_v<T>
         };
     };
 }
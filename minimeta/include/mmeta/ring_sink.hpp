@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "minimeta.hpp"
+
+namespace mmeta {
+    // A committed record inside the ring. Data points straight into the ring's memory and is only
+    // valid inside the drain callback.
+    struct ring_record {
+        hash_type Type;
+        const binary_buffer_type *Data;
+        size_t Size;
+
+        template <typename T>
+        bool is() const { return Type == typemeta_v<T>.hash(); }
+
+        template <typename T>
+        std::enable_if_t<is_serializable_v<T>, T>
+        decode() const {
+            memory_buffer_read from { Data, Size };
+            return deserialize<T>(from);
+        }
+    };
+
+    // Lock-free multi-producer, single-consumer ring of serialized records.
+    // Producers reserve the record's exact size with one CAS, serialize straight into the ring and
+    // publish it by storing its header. The consumer hands out records in place, then releases the
+    // whole batch at once.
+    // Record: [header: u64 (length | padding bit), 0 until committed][type hash: u64][payload], padded to 8 bytes
+    class mpsc_ring_sink {
+    public:
+        // 'capacity' is rounded up to a power of two
+        explicit mpsc_ring_sink(size_t capacity) :
+            m_capacity(round_capacity(capacity)),
+            m_words(new std::atomic<uint64_t>[m_capacity / kWordSize]) {
+            for(size_t i = 0; i < m_capacity / kWordSize; i++) {
+                m_words[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        mpsc_ring_sink(const mpsc_ring_sink&) = delete;
+        mpsc_ring_sink& operator=(const mpsc_ring_sink&) = delete;
+
+        size_t capacity() const { return m_capacity; }
+
+        // Returns false when the ring doesn't have room for the record right now, or when the value
+        // didn't serialize to exactly its serialized_size(), in which case the slot is skipped as padding
+        template <typename T>
+        std::enable_if_t<is_serializable_v<T>, bool>
+        try_push(const T& value) {
+            return write_record(value) == push_result::Pushed;
+        }
+
+        // Spins until there's room. Records that can never fit or fail to serialize return false.
+        template <typename T>
+        std::enable_if_t<is_serializable_v<T>, bool>
+        push(const T& value) {
+            if(align(kRecordHeaderSize + serialized_size(value)) > m_capacity / 2) return false;
+            push_result result;
+            while((result = write_record(value)) == push_result::Full) {
+                std::this_thread::yield();
+            }
+            return result == push_result::Pushed;
+        }
+
+        // Consumer side, calls fn(const ring_record&) for every committed record in order and
+        // returns how many were drained. Stops at the first record that's still being written.
+        template <typename Fn>
+        size_t drain(Fn&& fn) {
+            const uint64_t head = m_head.load(std::memory_order_acquire);
+            const uint64_t start = m_tail.load(std::memory_order_relaxed);
+
+            uint64_t tail = start;
+            size_t count = 0;
+            while(tail != head) {
+                const size_t offset = static_cast<size_t>(tail & (m_capacity - 1));
+                const uint64_t header = word_at(offset).load(std::memory_order_acquire);
+                if(header == 0) break;
+
+                const size_t length = static_cast<size_t>(header & ~kPaddingBit);
+                if((header & kPaddingBit) == 0) {
+                    const binary_buffer_type *record = bytes() + offset;
+                    ring_record view;
+                    memcpy(&view.Type, record + kWordSize, sizeof(view.Type));
+                    view.Data = record + kRecordHeaderSize;
+                    view.Size = length - kRecordHeaderSize;
+                    fn(static_cast<const ring_record&>(view));
+                    count++;
+                }
+                tail += length;
+            }
+
+            release(start, tail);
+            return count;
+        }
+
+    private:
+        enum class push_result { Pushed, Full, Failed };
+
+        static constexpr size_t kWordSize = sizeof(uint64_t);
+        static constexpr size_t kRecordHeaderSize = 2 * kWordSize;
+        static constexpr uint64_t kPaddingBit = uint64_t(1) << 63;
+
+        struct fixed_streambuf : public std::streambuf {
+            void reset(binary_buffer_type *data, size_t size) { setp(data, data + size); }
+            bool full() const { return pptr() == epptr(); }
+        };
+
+        static constexpr size_t align(size_t size) { return (size + kWordSize - 1) & ~(kWordSize - 1); }
+
+        static size_t round_capacity(size_t capacity) {
+            size_t rounded = 2 * kRecordHeaderSize;
+            while(rounded < capacity) rounded <<= 1;
+            return rounded;
+        }
+
+        template <typename T>
+        push_result write_record(const T& value) {
+            // Constructing a stream is more expensive than most records, so each thread keeps one around
+            thread_local fixed_streambuf payload;
+            thread_local binary_buffer_write to { &payload };
+
+            const size_t payloadSize = serialized_size(value, to);
+            const size_t length = align(kRecordHeaderSize + payloadSize);
+
+            size_t offset;
+            if(!reserve(length, offset)) return push_result::Full;
+
+            binary_buffer_type *record = bytes() + offset;
+            static constexpr hash_type type = typemeta_v<T>.hash();
+            memcpy(record + kWordSize, &type, sizeof(type));
+
+            payload.reset(record + kRecordHeaderSize, payloadSize);
+            to.clear();
+            serialize(value, to);
+
+            // A short or failed write would publish stale bytes, so the slot is committed as padding instead
+            if(!to.good() || !payload.full()) {
+                word_at(offset).store(length | kPaddingBit, std::memory_order_release);
+                return push_result::Failed;
+            }
+            word_at(offset).store(length, std::memory_order_release);
+            return push_result::Pushed;
+        }
+
+        binary_buffer_type *bytes() { return reinterpret_cast<binary_buffer_type*>(m_words.get()); }
+        std::atomic<uint64_t>& word_at(size_t offset) { return m_words[offset / kWordSize]; }
+
+        // Records never wrap, if one doesn't fit before the end of the ring the rest of it is
+        // reserved too and marked as padding
+        bool reserve(size_t length, size_t& offset) {
+            uint64_t head = m_head.load(std::memory_order_relaxed);
+            size_t untilEnd, total;
+            do {
+                offset = static_cast<size_t>(head & (m_capacity - 1));
+                untilEnd = m_capacity - offset;
+                total = length <= untilEnd ? length : untilEnd + length;
+                if(head + total - m_tail.load(std::memory_order_acquire) > m_capacity) return false;
+            } while(!m_head.compare_exchange_weak(head, head + total, std::memory_order_relaxed));
+
+            if(length > untilEnd) {
+                word_at(offset).store(untilEnd | kPaddingBit, std::memory_order_release);
+                offset = 0;
+            }
+            return true;
+        }
+
+        // Zeroes the drained range so stale bytes are never mistaken for a header, then hands it back to producers
+        void release(uint64_t from, uint64_t to) {
+            if(from == to) return;
+            const size_t begin = static_cast<size_t>(from & (m_capacity - 1));
+            const size_t size = static_cast<size_t>(to - from);
+            const size_t first = size < m_capacity - begin ? size : m_capacity - begin;
+            memset(bytes() + begin, 0, first);
+            memset(bytes(), 0, size - first);
+            m_tail.store(to, std::memory_order_release);
+        }
+
+        const size_t m_capacity;
+        std::unique_ptr<std::atomic<uint64_t>[]> m_words;
+
+        alignas(64) std::atomic<uint64_t> m_head { 0 };     // Next byte producers reserve
+        alignas(64) std::atomic<uint64_t> m_tail { 0 };     // First byte not yet released by the consumer
+    };
+}
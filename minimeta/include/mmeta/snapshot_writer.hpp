@@ -0,0 +1,185 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "minimeta.hpp"
+#include "checksum.hpp"
+#include "compression.hpp"
+
+namespace mmeta {
+    struct snapshot_options {
+        bool Checksum = true;       // Wraps the snapshot in a CRC32C frame
+        bool Compress = false;
+        compression_level Level = compression_level::fast;
+    };
+
+    // Serializes snapshots on the caller's thread into one of two reusable buffers, then checksums,
+    // compresses and writes them to disk on a background thread. The caller only blocks on capture,
+    // or when both buffers are still waiting to be written.
+    class snapshot_writer {
+    public:
+        using callback_type = std::function<void(bool)>;
+
+        explicit snapshot_writer(snapshot_options options = {}) :
+            m_options(options),
+            m_worker([this] { run(); }) {}
+
+        ~snapshot_writer() {
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+                m_stopping = true;
+            }
+            m_condition.notify_all();
+            m_worker.join();
+        }
+
+        snapshot_writer(const snapshot_writer&) = delete;
+        snapshot_writer& operator=(const snapshot_writer&) = delete;
+
+        // Both the future and the callback receive whether the snapshot made it to disk
+        template <typename T>
+        std::enable_if_t<is_serializable_v<T>, std::future<bool>>
+        snapshot(const T& value, std::string path, callback_type onComplete = nullptr) {
+            slot& target = acquire_slot();
+            try {
+                target.Buffer.clear();
+                serialize(value, target.Buffer);
+            }
+            catch(...) {
+                release_slot(target);
+                throw;
+            }
+            return submit(target, std::move(path), std::move(onComplete));
+        }
+
+        // Blocks until every submitted snapshot is written and its callback has returned, so it can't be called from a callback
+        void flush() {
+            std::unique_lock<std::mutex> lock { m_mutex };
+            m_condition.wait(lock, [this] { return m_inFlight == 0; });
+        }
+
+    private:
+        struct slot {
+            memory_buffer_write Buffer;
+            bool Busy = false;
+            std::string Path;
+            std::promise<bool> Promise;
+            callback_type Callback;
+        };
+
+        slot& acquire_slot() {
+            std::unique_lock<std::mutex> lock { m_mutex };
+            slot *freeSlot = nullptr;
+            m_condition.wait(lock, [&] {
+                for(auto& candidate : m_slots) {
+                    if(!candidate.Busy) freeSlot = &candidate;
+                }
+                return freeSlot != nullptr;
+            });
+            freeSlot->Busy = true;
+            return *freeSlot;
+        }
+
+        void release_slot(slot& target) {
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+                target.Busy = false;
+            }
+            m_condition.notify_all();
+        }
+
+        std::future<bool> submit(slot& target, std::string path, callback_type onComplete) {
+            target.Path = std::move(path);
+            target.Callback = std::move(onComplete);
+            target.Promise = std::promise<bool>();
+            std::future<bool> result = target.Promise.get_future();
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+                m_pending.push_back(&target);
+                m_inFlight++;
+            }
+            m_condition.notify_all();
+            return result;
+        }
+
+        void run() {
+            while(true) {
+                slot *job = nullptr;
+                {
+                    std::unique_lock<std::mutex> lock { m_mutex };
+                    m_condition.wait(lock, [this] { return !m_pending.empty() || m_stopping; });
+                    if(m_pending.empty()) return;
+                    job = m_pending.front();
+                    m_pending.pop_front();
+                }
+
+                const bool written = write_job(*job);
+                std::promise<bool> promise = std::move(job->Promise);
+                callback_type callback = std::move(job->Callback);
+                release_slot(*job);
+
+                promise.set_value(written);
+                if(callback) callback(written);
+
+                {
+                    std::lock_guard<std::mutex> lock { m_mutex };
+                    m_inFlight--;
+                }
+                m_condition.notify_all();
+            }
+        }
+
+        // Written next to the target and renamed over it, so a crash mid-write leaves the previous snapshot intact
+        bool write_job(const slot& job) const {
+            const std::string temporaryPath = job.Path + ".tmp";
+            std::ofstream file { temporaryPath, std::ios::binary | std::ios::trunc };
+            if(!file) return false;
+
+            auto write_payload = [&](binary_buffer_write& to) {
+                if(m_options.Checksum) {
+                    write_frame(job.Buffer.data(), job.Buffer.size(), to);
+                }
+                else {
+                    to.write(job.Buffer.data(), job.Buffer.size());
+                }
+            };
+
+            if(m_options.Compress) {
+                compressed_buffer_write compressed { file, m_options.Level };
+                write_payload(compressed);
+                compressed.close();
+            }
+            else {
+                write_payload(file);
+            }
+
+            file.close();
+
+            std::error_code error;
+            if(!file.fail()) {
+                std::filesystem::rename(temporaryPath, job.Path, error);
+                if(!error) return true;
+            }
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        const snapshot_options m_options;
+        std::array<slot, 2> m_slots;
+        std::deque<slot*> m_pending;
+        size_t m_inFlight = 0;
+        bool m_stopping = false;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::thread m_worker;
+    };
+}
@@ -0,0 +1,573 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <new>
+
+#include "minimeta.hpp"
+
+namespace mmeta {
+    // ========================================================================-------
+    // ======= Leaf flattening
+    // ========================================================================-------
+
+    // Fundamental field reachable from a class, possibly through nested reflected classes
+    struct soa_leaf {
+        size_t Offset;      // Offset from the start of the outermost class
+        size_t Size;
+        hash_type Hash;
+    };
+
+    template <typename T>
+    constexpr size_t soa_leaf_count();
+
+    template <typename T, size_t I>
+    constexpr size_t soa_field_leaf_count() {
+        using field_type = reflected_field_t<T, I>;
+        if constexpr (is_hashed_type_v<field_type>) {
+            return soa_leaf_count<field_type>();
+        }
+        else {
+            static_assert(is_fundamental_hash(mmclass_storage<T>::Fields[I].hash()) && "soa_vector only supports fields that are fundamentals or reflected classes of fundamentals.");
+            return 1;
+        }
+    }
+
+    template <typename T, size_t... I>
+    constexpr size_t soa_leaf_count_impl(std::index_sequence<I...>) {
+        return (soa_field_leaf_count<T, I>() + ... + 0);
+    }
+
+    template <typename T>
+    constexpr size_t soa_leaf_count() {
+        return soa_leaf_count_impl<T>(std::make_index_sequence<mmclass_storage<T>::field_count()>());
+    }
+
+    template <typename T, size_t N>
+    constexpr void collect_soa_leaves(std::array<soa_leaf, N>& leaves, size_t& count, size_t baseOffset);
+
+    template <typename T, size_t I, size_t N>
+    constexpr void collect_soa_field(std::array<soa_leaf, N>& leaves, size_t& count, size_t baseOffset) {
+        using field_type = reflected_field_t<T, I>;
+        const mmfield& field = mmclass_storage<T>::Fields[I];
+        if constexpr (is_hashed_type_v<field_type>) {
+            collect_soa_leaves<field_type>(leaves, count, baseOffset + field.offset());
+        }
+        else {
+            leaves[count++] = { baseOffset + field.offset(), field.type().size(), field.hash() };
+        }
+    }
+
+    template <typename T, size_t N, size_t... I>
+    constexpr void collect_soa_leaves_impl(std::array<soa_leaf, N>& leaves, size_t& count, size_t baseOffset, std::index_sequence<I...>) {
+        (collect_soa_field<T, I>(leaves, count, baseOffset), ...);
+    }
+
+    template <typename T, size_t N>
+    constexpr void collect_soa_leaves(std::array<soa_leaf, N>& leaves, size_t& count, size_t baseOffset) {
+        collect_soa_leaves_impl<T>(leaves, count, baseOffset, std::make_index_sequence<mmclass_storage<T>::field_count()>());
+    }
+
+    template <typename T>
+    constexpr std::array<soa_leaf, soa_leaf_count<T>()> make_soa_leaves() {
+        std::array<soa_leaf, soa_leaf_count<T>()> leaves{};
+        size_t count = 0;
+        collect_soa_leaves<T>(leaves, count, 0);
+        return leaves;
+    }
+
+    template <typename T>
+    inline constexpr auto soa_leaves_v = make_soa_leaves<T>();
+
+    // Bytes one element takes across all columns
+    template <typename T>
+    constexpr size_t soa_row_size() {
+        size_t size = 0;
+        for(const soa_leaf& leaf : soa_leaves_v<T>) size += leaf.Size;
+        return size;
+    }
+
+    // Resolves a dotted path like "Position.X" to the offset of the leaf it names
+    template <typename T>
+    constexpr size_t soa_leaf_offset(std::string_view path);
+
+    template <typename T, size_t I>
+    constexpr size_t soa_field_leaf_offset(std::string_view rest, bool hasRest) {
+        using field_type = reflected_field_t<T, I>;
+        const size_t base = mmclass_storage<T>::Fields[I].offset();
+        if constexpr (is_hashed_type_v<field_type>) {
+            const size_t nested = hasRest ? soa_leaf_offset<field_type>(rest) : invalid_field_index;
+            return nested != invalid_field_index ? base + nested : invalid_field_index;
+        }
+        else {
+            return hasRest ? invalid_field_index : base;
+        }
+    }
+
+    template <typename T, size_t... I>
+    constexpr size_t soa_leaf_offset_impl(size_t index, std::string_view rest, bool hasRest, std::index_sequence<I...>) {
+        size_t offset = invalid_field_index;
+        ((I == index ? (offset = soa_field_leaf_offset<T, I>(rest, hasRest), true) : false) || ...);
+        return offset;
+    }
+
+    template <typename T>
+    constexpr size_t soa_leaf_offset(std::string_view path) {
+        const size_t dot = path.find('.');
+        const bool hasRest = dot != std::string_view::npos;
+        const std::string_view rest = hasRest ? path.substr(dot + 1) : std::string_view{};
+        const size_t index = field_index<T>(path.substr(0, dot));
+        if(index == invalid_field_index || (hasRest && rest.empty())) {
+            return invalid_field_index;
+        }
+        return soa_leaf_offset_impl<T>(index, rest, hasRest, std::make_index_sequence<mmclass_storage<T>::field_count()>());
+    }
+
+    // ========================================================================-------
+    // ======= Structure of arrays
+    // ========================================================================-------
+
+    template <typename F>
+    struct column_span {
+        F *Ptr;
+        size_t Size;
+
+        constexpr F *data() const { return Ptr; }
+        constexpr F *begin() const { return Ptr; }
+        constexpr F *end() const { return Ptr + Size; }
+        constexpr size_t size() const { return Size; }
+        constexpr F& operator[](size_t index) const { return Ptr[index]; }
+    };
+
+    // Stores each fundamental leaf of T in its own aligned array, so loops that only touch a few
+    // fields don't pull the others into cache. Fields of T that aren't reflected aren't stored, and
+    // are default initialized when an element is read back.
+    template <typename T>
+    class soa_vector {
+    public:
+        using value_type = T;
+        using size_type = size_t;
+
+        static constexpr const std::array<soa_leaf, soa_leaf_count<T>()>& leaves = soa_leaves_v<T>;
+        static constexpr size_t column_count = soa_leaf_count<T>();
+        static constexpr size_t row_size = soa_row_size<T>();
+        static constexpr size_t column_alignment = 64;
+
+        // Proxy to an element, reads gather every column and writes scatter to them
+        class reference {
+        public:
+            reference(soa_vector& owner, size_t index) : m_owner(&owner), m_index(index) {}
+
+            operator T() const { return m_owner->get(m_index); }
+
+            reference& operator=(const T& value) {
+                m_owner->set(m_index, value);
+                return *this;
+            }
+
+            reference& operator=(const reference& other) { return *this = static_cast<T>(other); }
+
+            template <typename F>
+            F& field(size_t columnIndex) const { return m_owner->template column<F>(columnIndex)[m_index]; }
+
+            template <typename F>
+            F& field(std::string_view path) const { return field<F>(column_index(path)); }
+
+        private:
+            soa_vector *m_owner;
+            size_t m_index;
+        };
+
+        soa_vector() = default;
+
+        explicit soa_vector(size_t count) { resize(count); }
+
+        soa_vector(const soa_vector& other) {
+            reserve(other.m_size);
+            m_size = other.m_size;
+            for(size_t c = 0; c < column_count && m_size > 0; c++) {
+                memcpy(m_columns[c], other.m_columns[c], m_size * leaves[c].Size);
+            }
+        }
+
+        soa_vector(soa_vector&& other) noexcept { swap(other); }
+
+        soa_vector& operator=(soa_vector other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~soa_vector() {
+            for(auto column : m_columns) {
+                deallocate(column);
+            }
+        }
+
+        void swap(soa_vector& other) noexcept {
+            std::swap(m_columns, other.m_columns);
+            std::swap(m_size, other.m_size);
+            std::swap(m_capacity, other.m_capacity);
+        }
+
+        inline size_t size() const { return m_size; }
+        inline size_t capacity() const { return m_capacity; }
+        inline bool empty() const { return m_size == 0; }
+
+        void reserve(size_t capacity) {
+            if(capacity <= m_capacity) return;
+
+            for(size_t c = 0; c < column_count; c++) {
+                binary_buffer_type *column = allocate(capacity * leaves[c].Size);
+                if(m_size > 0) {
+                    memcpy(column, m_columns[c], m_size * leaves[c].Size);
+                }
+                deallocate(m_columns[c]);
+                m_columns[c] = column;
+            }
+            m_capacity = capacity;
+        }
+
+        // New elements take the values of a default constructed T
+        void resize(size_t count) {
+            reserve(count);
+            const size_t first = m_size;
+            m_size = count;
+            const T defaultValue{};
+            for(size_t i = first; i < count; i++) {
+                set(i, defaultValue);
+            }
+        }
+
+        void clear() { m_size = 0; }
+
+        void push_back(const T& value) {
+            if(m_size == m_capacity) {
+                reserve(m_capacity > 0 ? m_capacity * 2 : 8);
+            }
+            set(m_size++, value);
+        }
+
+        void pop_back() {
+            assert(m_size > 0 && "Trying to pop from an empty soa_vector.");
+            m_size--;
+        }
+
+        reference operator[](size_t index) { return { *this, index }; }
+        T operator[](size_t index) const { return get(index); }
+
+        T get(size_t index) const {
+            assert(index < m_size && "soa_vector index out of range.");
+            T value{};
+            for(size_t c = 0; c < column_count; c++) {
+                memcpy(reinterpret_cast<binary_buffer_type*>(&value) + leaves[c].Offset, m_columns[c] + index * leaves[c].Size, leaves[c].Size);
+            }
+            return value;
+        }
+
+        void set(size_t index, const T& value) {
+            assert(index < m_size && "soa_vector index out of range.");
+            for(size_t c = 0; c < column_count; c++) {
+                memcpy(m_columns[c] + index * leaves[c].Size, reinterpret_cast<const binary_buffer_type*>(&value) + leaves[c].Offset, leaves[c].Size);
+            }
+        }
+
+        // Index of the column that stores the leaf named by a dotted path, e.g: "Position.X"
+        static constexpr size_t column_index(std::string_view path) {
+            const size_t offset = soa_leaf_offset<T>(path);
+            for(size_t c = 0; c < column_count && offset != invalid_field_index; c++) {
+                if(leaves[c].Offset == offset) return c;
+            }
+            return invalid_field_index;
+        }
+
+        template <typename F>
+        column_span<F> column(size_t index) {
+            assert_column_type<F>(index);
+            return { reinterpret_cast<F*>(m_columns[index]), m_size };
+        }
+
+        template <typename F>
+        column_span<const F> column(size_t index) const {
+            assert_column_type<F>(index);
+            return { reinterpret_cast<const F*>(m_columns[index]), m_size };
+        }
+
+        template <typename F>
+        column_span<F> column(std::string_view path) { return column<F>(column_index(path)); }
+
+        template <typename F>
+        column_span<const F> column(std::string_view path) const { return column<F>(column_index(path)); }
+
+        binary_buffer_type *column_data(size_t index) { return m_columns[index]; }
+        const binary_buffer_type *column_data(size_t index) const { return m_columns[index]; }
+
+        void write_columns(binary_buffer_write& to) const {
+            for(size_t c = 0; c < column_count; c++) {
+                to.write(m_columns[c], m_size * leaves[c].Size);
+            }
+        }
+
+        void read_columns(binary_buffer_read& from, size_t count) {
+            reserve(count);
+            m_size = count;
+            for(size_t c = 0; c < column_count; c++) {
+                from.read(m_columns[c], m_size * leaves[c].Size);
+            }
+        }
+
+    private:
+        template <typename F>
+        static void assert_column_type(size_t index) {
+            assert(index < column_count && "soa_vector column out of range.");
+            assert(utils::hash(utils::type_name<F>::name) == leaves[index].Hash && ">> ERROR: Trying to get column using wrong type.");
+        }
+
+        static binary_buffer_type *allocate(size_t bytes) {
+            return static_cast<binary_buffer_type*>(::operator new(bytes, std::align_val_t{ column_alignment }));
+        }
+
+        static void deallocate(binary_buffer_type *column) {
+            if(column) {
+                ::operator delete(column, std::align_val_t{ column_alignment });
+            }
+        }
+
+        binary_buffer_type *m_columns[column_count] = {};
+        size_t m_size = 0;
+        size_t m_capacity = 0;
+    };
+
+    // ========================================================================-------
+    // ======= Serialization
+    // ========================================================================-------
+
+    template<class T>
+    struct is_soa_vector : std::false_type {};
+
+    template<typename T>
+    struct is_soa_vector<soa_vector<T>> : std::true_type {};
+
+    template<typename T>
+    inline constexpr bool is_soa_vector_v = is_soa_vector<T>::value;
+
+#ifndef __MMETA__
+    template <typename T>
+    struct is_serializable<soa_vector<T>> {
+        static constexpr bool value = is_serializable<T>::value;
+    };
+#endif
+
+    // Written column by column, so each column is a single bulk copy
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>>
+    write_serializable(const mmfield* container, const void *from, binary_buffer_write& to) {
+        using arr_value_type = typename S::value_type;
+        using arr_size_type = typename S::size_type;
+
+        const S* value = static_cast<const S*>(from);
+        static constexpr hash_type version = classmeta_v<arr_value_type>.version();
+        write<hash_type>(container, &version, to);
+
+        arr_size_type elementCount = value->size();
+        write<arr_size_type>(container, &elementCount, to);
+        value->write_columns(to);
+    }
+
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>>
+    read_serializable(const mmfield* fieldMeta, binary_buffer_read& from, void *to) {
+        using arr_value_type = typename S::value_type;
+        using arr_size_type = typename S::size_type;
+
+        hash_type version;
+        read<hash_type>(fieldMeta, from, &version);
+
+        assert(version == classmeta_v<arr_value_type>.version() && "Trying to read binary from different version.");
+
+        arr_size_type size = 0;
+        read<arr_size_type>(fieldMeta, from, &size);
+        static_cast<S*>(to)->read_columns(from, size);
+    }
+
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>, size_t>
+    binary_size_serializable(const mmfield* container, const void *from) {
+        return sizeof(hash_type) + sizeof(typename S::size_type) + static_cast<const S*>(from)->size() * S::row_size;
+    }
+
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>, bool>
+    read_validated_serializable(const mmfield* fieldMeta, validating_reader& from, void *to) {
+        using arr_value_type = typename S::value_type;
+        using arr_size_type = typename S::size_type;
+
+        hash_type version;
+        if(!from.take(&version, sizeof(version))) return false;
+        if(version != classmeta_v<arr_value_type>.version()) return from.fail(decode_error::version_mismatch);
+
+        arr_size_type size = 0;
+        if(!from.take(&size, sizeof(size)) || !from.reserve(size, S::row_size, S::row_size)) return false;
+
+        S* value = static_cast<S*>(to);
+        value->resize(size);
+        for(size_t column = 0; column < S::column_count; column++) {
+            if(!from.take(value->column_data(column), size * S::leaves[column].Size)) return false;
+        }
+        return true;
+    }
+
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>, bool>
+    equal_serializable(const mmfield* container, const void *a, const void *b) {
+        const S& left = *static_cast<const S*>(a);
+        const S& right = *static_cast<const S*>(b);
+        if(left.size() != right.size()) return false;
+        for(size_t column = 0; column < S::column_count && !left.empty(); column++) {
+            if(memcmp(left.column_data(column), right.column_data(column), left.size() * S::leaves[column].Size) != 0) return false;
+        }
+        return true;
+    }
+
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>, size_t>
+    hash_serializable(const mmfield* container, const void *from, size_t seed) {
+        const S& value = *static_cast<const S*>(from);
+        seed = hash_combine(seed, value.size());
+        for(size_t column = 0; column < S::column_count && !value.empty(); column++) {
+            seed = hash_memory(value.column_data(column), value.size() * S::leaves[column].Size, seed);
+        }
+        return seed;
+    }
+
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>>
+    write_serializable_yaml(const basic_mmfield<Meta>* self, const void* from, yaml_node& to) {
+        using arr_value_type = typename S::value_type;
+
+        const S* value = static_cast<const S*>(from);
+        for(size_t i = 0; i < value->size(); i++) {
+            const arr_value_type element = value->get(i);
+            yaml_node seqNode = yaml_node();
+            to.push_back(seqNode);
+            write_yaml<arr_value_type, Meta>(nullptr, &element, seqNode);
+        }
+    }
+
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>>
+    read_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        using arr_value_type = typename S::value_type;
+
+        S* value = static_cast<S*>(to);
+        value->resize(from.size());
+
+        size_t i = 0;
+        for(auto& yamlField : from) {
+            arr_value_type element{};
+            read_yaml<arr_value_type>(self, yamlField, &element);
+            value->set(i++, element);
+        }
+    }
+
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>, bool>
+    apply_serializable_yaml(const basic_mmfield<Meta>* self, const yaml_node& from, void *to) {
+        using arr_value_type = typename S::value_type;
+
+        if(!from.IsDefined()) return false;
+
+        S* value = static_cast<S*>(to);
+        const size_t kept = std::min<size_t>(value->size(), from.size());
+        bool changed = value->size() != from.size();
+        value->resize(from.size());
+
+        size_t i = 0;
+        for(auto& yamlField : from) {
+            arr_value_type element = i < kept ? value->get(i) : arr_value_type{};
+            if(i < kept) {
+                if(apply_yaml_at<arr_value_type, Meta>(self, yamlField, &element)) {
+                    value->set(i, element);
+                    changed = true;
+                }
+            }
+            else {
+                read_yaml<arr_value_type>(self, yamlField, &element);
+                value->set(i, element);
+            }
+            i++;
+        }
+        return changed;
+    }
+
+    // Columns of soa_vector fields have the same layout as the ones of a std::vector<T>
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>>
+    write_serializable_column(const mmfield* self, const std::string& path, const void * const * values, size_t count, column_sink& to) {
+        using vector_type = std::vector<typename S::value_type>;
+
+        std::vector<vector_type> rows(count);
+        std::vector<const void*> rowValues(count);
+        for(size_t i = 0; i < count; i++) {
+            const S* value = static_cast<const S*>(values[i]);
+            rows[i].reserve(value->size());
+            for(size_t j = 0; j < value->size(); j++) {
+                rows[i].push_back(value->get(j));
+            }
+            rowValues[i] = &rows[i];
+        }
+        write_serializable_column<vector_type, Meta>(self, path, rowValues.data(), count, to);
+    }
+
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>>
+    read_serializable_column(const mmfield* self, column_source& from, void * const * values, size_t count) {
+        using vector_type = std::vector<typename S::value_type>;
+
+        std::vector<vector_type> rows(count);
+        std::vector<void*> rowValues(count);
+        for(size_t i = 0; i < count; i++) {
+            rowValues[i] = &rows[i];
+        }
+        read_serializable_column<vector_type, Meta>(self, from, rowValues.data(), count);
+
+        for(size_t i = 0; i < count; i++) {
+            S* value = static_cast<S*>(values[i]);
+            value->resize(rows[i].size());
+            for(size_t j = 0; j < rows[i].size(); j++) {
+                value->set(j, rows[i][j]);
+            }
+        }
+    }
+
+    template <typename S, typename Meta = meta_type>
+    std::enable_if_t<is_soa_vector_v<S>, incremental_decoder::step_result>
+    decode_step(incremental_decoder& decoder, incremental_decoder::frame& frame) {
+        using step_result = incremental_decoder::step_result;
+        using arr_size_type = typename S::size_type;
+
+        S* value = static_cast<S*>(frame.Target);
+        if(frame.Index == 0) {
+            if(!decoder.take(&frame.Scratch, sizeof(hash_type), frame.Filled)) return step_result::need_more;
+            if(frame.Scratch != classmeta_v<typename S::value_type>.version()) return step_result::failed;
+            frame.Scratch = 0;
+            frame.Filled = 0;
+            frame.Index = 1;
+        }
+        if(frame.Index == 1) {
+            if(!decoder.take(&frame.Scratch, sizeof(arr_size_type), frame.Filled)) return step_result::need_more;
+            frame.Count = static_cast<size_t>(frame.Scratch);
+            // Columns are filled one after the other, so all rows have to exist up front
+            if(!decoder.reserve(frame.Count, sizeof(typename S::value_type))) return step_result::failed;
+            frame.Filled = 0;
+            frame.Index = 2;
+            value->resize(frame.Count);
+        }
+
+        // Columns are bulk copied one after the other
+        for(; frame.Index - 2 < S::column_count; frame.Index++, frame.Filled = 0) {
+            const size_t column = frame.Index - 2;
+            if(!decoder.take(value->column_data(column), frame.Count * S::leaves[column].Size, frame.Filled)) return step_result::need_more;
+        }
+        return step_result::finished;
+    }
+}
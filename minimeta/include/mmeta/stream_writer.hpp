@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cerrno>
+#include <functional>
+#include <vector>
+
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+#include "minimeta.hpp"
+
+namespace mmeta {
+    static constexpr size_t kDefaultStreamChunkSize = 64 * 1024;
+
+    // Receives each chunk as it's flushed, returns false to stop the stream
+    using chunk_callback = std::function<bool(const binary_buffer_type*, size_t)>;
+
+    // Stream buffer that holds at most one chunk, flushing it to a file descriptor or a callback
+    // when full. Writes bigger than a chunk (bulk vector blocks) skip the buffer and are gathered
+    // with whatever is pending into a single writev.
+    class chunked_streambuf : public std::streambuf {
+    public:
+        chunked_streambuf(int fd, size_t chunkSize = kDefaultStreamChunkSize) :
+            m_fd(fd),
+            m_chunk(chunkSize) {
+            setp(m_chunk.data(), m_chunk.data() + m_chunk.size());
+        }
+
+        chunked_streambuf(chunk_callback callback, size_t chunkSize = kDefaultStreamChunkSize) :
+            m_callback(std::move(callback)),
+            m_chunk(chunkSize) {
+            setp(m_chunk.data(), m_chunk.data() + m_chunk.size());
+        }
+
+        ~chunked_streambuf() override { flush_chunk(); }
+
+        bool failed() const { return m_failed; }
+
+    protected:
+        std::streamsize xsputn(const char_type* s, std::streamsize count) override {
+            if(m_failed) return 0;
+
+            const size_t size = static_cast<size_t>(count);
+            if(size < m_chunk.size()) {
+                const size_t available = static_cast<size_t>(epptr() - pptr());
+                if(size > available && !flush_chunk()) return 0;
+                memcpy(pptr(), s, size);
+                pbump(static_cast<int>(size));
+                return count;
+            }
+
+            if(!emit(pbase(), static_cast<size_t>(pptr() - pbase()), s, size)) return 0;
+            setp(m_chunk.data(), m_chunk.data() + m_chunk.size());
+            return count;
+        }
+
+        int_type overflow(int_type ch) override {
+            if(!flush_chunk()) return traits_type::eof();
+            if(!traits_type::eq_int_type(ch, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        int sync() override { return flush_chunk() ? 0 : -1; }
+
+    private:
+        bool flush_chunk() {
+            if(m_failed) return false;
+            const bool flushed = emit(pbase(), static_cast<size_t>(pptr() - pbase()), nullptr, 0);
+            setp(m_chunk.data(), m_chunk.data() + m_chunk.size());
+            return flushed;
+        }
+
+        // Sends the pending chunk followed by 'block', retrying partial writes
+        bool emit(const binary_buffer_type *pending, size_t pendingSize, const binary_buffer_type *block, size_t blockSize) {
+            if(m_callback) {
+                m_failed = (pendingSize > 0 && !m_callback(pending, pendingSize)) ||
+                           (blockSize > 0 && !m_callback(block, blockSize));
+                return !m_failed;
+            }
+
+#if defined(_WIN32)
+            m_failed = !write_all(pending, pendingSize) || !write_all(block, blockSize);
+#else
+            iovec parts[2] = {
+                { const_cast<binary_buffer_type*>(pending), pendingSize },
+                { const_cast<binary_buffer_type*>(block), blockSize }
+            };
+            iovec *part = parts;
+            int partCount = 2;
+            while(partCount > 0 && !m_failed) {
+                if(part->iov_len == 0) {
+                    part++;
+                    partCount--;
+                    continue;
+                }
+
+                const ssize_t written = ::writev(m_fd, part, partCount);
+                if(written < 0) {
+                    m_failed = errno != EINTR;
+                    continue;
+                }
+
+                size_t remaining = static_cast<size_t>(written);
+                while(partCount > 0 && remaining >= part->iov_len) {
+                    remaining -= part->iov_len;
+                    part++;
+                    partCount--;
+                }
+                if(partCount > 0) {
+                    part->iov_base = static_cast<binary_buffer_type*>(part->iov_base) + remaining;
+                    part->iov_len -= remaining;
+                }
+            }
+#endif
+            return !m_failed;
+        }
+
+#if defined(_WIN32)
+        bool write_all(const binary_buffer_type *data, size_t size) {
+            while(size > 0) {
+                const unsigned int count = size > 0x40000000 ? 0x40000000 : static_cast<unsigned int>(size);
+                const int written = ::_write(m_fd, data, count);
+                if(written < 0) {
+                    if(errno == EINTR) continue;
+                    return false;
+                }
+                data += written;
+                size -= static_cast<size_t>(written);
+            }
+            return true;
+        }
+#endif
+
+        int m_fd = -1;
+        chunk_callback m_callback;
+        std::vector<binary_buffer_type> m_chunk;
+        bool m_failed = false;
+    };
+
+    // Output stream whose extra memory is bounded by the chunk size, regardless of the object's size
+    //      mmeta::chunked_buffer_write out { fd };
+    //      mmeta::serialize(hugeValue, out);
+    //      out.close();
+    class chunked_buffer_write : public binary_buffer_write {
+    public:
+        chunked_buffer_write(int fd, size_t chunkSize = kDefaultStreamChunkSize) :
+            binary_buffer_write(nullptr),
+            m_buffer(fd, chunkSize) {
+            rdbuf(&m_buffer);
+        }
+
+        chunked_buffer_write(chunk_callback callback, size_t chunkSize = kDefaultStreamChunkSize) :
+            binary_buffer_write(nullptr),
+            m_buffer(std::move(callback), chunkSize) {
+            rdbuf(&m_buffer);
+        }
+
+        // Flushes the last chunk, returns whether everything was written
+        bool close() {
+            flush();
+            return !m_buffer.failed() && good();
+        }
+
+    private:
+        chunked_streambuf m_buffer;
+    };
+}